@@ -7,9 +7,64 @@
 
 
 #include <tuple>
+#include <string>
+#include <string_view>
+#include <optional>
 #include <vector>
 #include <forward_list>
+#include <memory>
+#include <array>
+#include <iterator>
 #include <cstring>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <system_error>
+#include <istream>
+#include <ostream>
+#include <exception>
+#include <thread>
+
+#if __has_include(<bit>)
+#include <bit>
+#endif
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#if __has_include(<sys/uio.h>)
+#include <sys/uio.h>
+#include <climits>
+#endif
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+//Kernels using instruction sets which are not enabled by compiler flags are selected at runtime on x86 with GCC and Clang
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SERIALIZER_X86_DISPATCH
+#define SERIALIZER_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SERIALIZER_TARGET(isa)
+#endif
+
+#if defined(SERIALIZER_X86_DISPATCH) || defined(__AVX2__) || defined(__SSSE3__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 
 //! Byte order of serialized variables
@@ -25,6 +80,14 @@ enum ByteOrder
     Network = BigEndian
 };
 
+//! Encoding of integers in serialized data
+enum IntegerEncoding
+{
+    FixedWidth,                 ///<Integers and container sizes are written with the width of their type
+    VarintSize,                 ///<Container sizes are written as LEB128 variable length integers
+    Varint                      ///<Container sizes and integer values are written as LEB128 variable length integers, signed values are ZigZag encoded
+};
+
 namespace serializerTuple
 {
 #pragma GCC diagnostic push
@@ -128,6 +191,22 @@ namespace serializerTuple
     const auto &tuple_get_f(const T &val)
     { return tuple_get<T, i>::func(val); }
 
+/*!
+ * Marks if memory offset of value with index i within custom serializable value is known
+ */
+    template<class T, size_t i, class = void>
+    struct has_tuple_offset : std::false_type
+    {
+    };
+
+    template<class T, size_t i>
+    struct has_tuple_offset<T, i, std::void_t<decltype(tuple_get<T, i>::offset())>> : std::true_type
+    {
+    };
+
+    template<class T, size_t i>
+    constexpr bool has_tuple_offset_v = has_tuple_offset<T, i>::value;
+
 /*!
  * Get type of value with index i from custom serializable value
  */
@@ -154,1132 +233,5409 @@ namespace Serialization
     public:
         explicit DeserializationError(const std::string& msg) : std::runtime_error(msg) {}
     };
-}
 
-/*!
- * Variable serializer class
- * @note Cant be used to serialize arithmetic values, c-style arrays and most of standard c++ containers
- * @tparam order Serialization byte order
- * @tparam sizeT Type to represent container size, if void then size type provided by container will be used
- */
-template<ByteOrder order = Host, class sizeT = void>
-class Serializer
-{
-public:
-
-    //! Type of values recognized by serializer
-    enum ValueType
+    /*!
+     * Allocator which default-initializes values instead of value-initializing them
+     * @note Resizing a container of trivial values with this allocator leaves new values uninitialized
+     * @tparam T Allocated value type
+     * @tparam Base Underlying allocator
+     */
+    template<class T, class Base = std::allocator<T>>
+    class DefaultInitAllocator : public Base
     {
-        Optimized,              ///<Type is specifically optimized to be serialized in an efficient way
-        Arithmetic,             ///<Type is arithmetic and will be simply converted to bytes (e.g. int)
-        Enum,                   ///<Type is enum and will be simply converted to bytes
-        ArithmeticArray,        ///<Type is an array of arithmetic values, it will me copied bytewise (e.g. int[4])
-        ArithmeticContiguous,   ///<Type stores arithmetic values contiguously, it's data will me copied bytewise with addition of size (e.g. std::vector<int>)
-        Array,                  ///<Type is an array of custom values, each element will be serialized consequently (e.g. std::string[4])
-        Tuple,                  ///<Type is a tuple of custom values, each element will be serialized consequently (e.g. std::pair<int, int>)
-        Iterable,               ///<Type is an iterable container of custom values, each element will be serialized consequently (e.g. std::vector<std::string>)
-        NonSerializable         ///<Type can not be serialized
-    };
-
-private:
-
-    template<class T>
-    static constexpr bool is_tuple_serializable_v = serializerTuple::is_tuple_serializable_v<T>;
-
-    template<class T>
-    static constexpr size_t tuple_size_v = serializerTuple::tuple_size_v<T>;
-
-    template<class T, size_t i>
-    static auto &tuple_get_f(T &val)
-    { return serializerTuple::tuple_get_f<T, i>(val); }
+    public:
+        template<class U>
+        struct rebind
+        {
+            typedef DefaultInitAllocator<U, typename std::allocator_traits<Base>::template rebind_alloc<U>> other;
+        };
 
-    template<class T, size_t i>
-    static const auto &tuple_get_f(const T &val)
-    { return serializerTuple::tuple_get_f<T, i>(val); }
+        using Base::Base;
 
-    template<class T, size_t i>
-    using tuple_element_t = typename serializerTuple::tuple_element_t<T, i>;
+        DefaultInitAllocator() = default;
 
-    template<class T>
-    using plain_value = std::remove_cv_t<std::remove_reference_t<T>>;
+        template<class U, class BaseU>
+        DefaultInitAllocator(const DefaultInitAllocator<U, BaseU> &other) noexcept : Base(other) {}
 
-    template<class T>
-    static constexpr std::add_lvalue_reference_t<T> ldeclval();
+        template<class U>
+        void construct(U *ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+        {
+            ::new(static_cast<void *>(ptr)) U;
+        }
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+        template<class U, class ... Args>
+        void construct(U *ptr, Args &&... args)
+        {
+            std::allocator_traits<Base>::construct(static_cast<Base &>(*this), ptr, std::forward<Args>(args)...);
+        }
+    };
 
-    template<class T>
-    struct is_complete_type
+    //Containers using DefaultInitAllocator, which are not zero filled when resized
+    template<class A>
+    struct is_default_init_allocator : std::false_type
     {
-    private:
-        template<class C>
-        static constexpr std::true_type test(int(*)[sizeof(C)]);
-
-        template<class>
-        static constexpr std::false_type test(...);
-
-    public:
-        static constexpr bool value = decltype(test<T>(0))::value;
     };
 
-    template<class T>
-    static constexpr bool is_complete_type_v = is_complete_type<T>::value;
+    template<class V, class Base>
+    struct is_default_init_allocator<DefaultInitAllocator<V, Base>> : std::true_type
+    {
+    };
 
     template<class T, class = void>
-    struct is_resizable
+    struct is_default_init_allocated : std::false_type
     {
-    private:
-        template<class C>
-        static constexpr auto
-        test(int) -> decltype(ldeclval<C>().resize(ldeclval<decltype(std::size(ldeclval<C>()))>()), std::true_type());
-
-        template<class>
-        static constexpr std::false_type test(...);
-
-    public:
-        static constexpr bool value = decltype(test<T>(0))::value;
     };
 
     template<class T>
-    struct is_resizable<T, std::enable_if_t<!std::is_class_v<T>>>
+    struct is_default_init_allocated<T, std::void_t<typename T::allocator_type>>
+        : is_default_init_allocator<typename T::allocator_type>
     {
-        static constexpr bool value = false;
     };
 
     template<class T>
-    static constexpr bool is_resizable_v = is_resizable<T>::value;
+    constexpr bool is_default_init_allocated_v = is_default_init_allocated<T>::value;
 
-    template<class T, class = void>
-    struct has_size
+    /*!
+     * Opt a container of sorted 32 or 64 bit integers into delta encoding with bitpacking, see DELTA_PACKED
+     * @tparam T Container type (e.g. std::set<uint64_t>)
+     */
+    template<class T>
+    struct is_delta_packed : std::false_type
     {
-    private:
-        template<class C>
-        static constexpr auto test(int) -> decltype(std::enable_if_t<std::is_integral_v<decltype(std::size(
-                ldeclval<C>()))>>(), std::true_type());
-
-        template<class>
-        static constexpr std::false_type test(...);
-
-    public:
-        static constexpr bool value = decltype(test<T>(0))::value;
     };
 
     template<class T>
-    static constexpr bool has_size_v = has_size<T>::value;
+    constexpr bool is_delta_packed_v = is_delta_packed<T>::value;
 
-    template<class T, class = void>
-    struct is_insertable
+    //! Reusable serialization buffer which is not zero filled when it grows
+    typedef std::vector<char, DefaultInitAllocator<char>> Buffer;
+
+    /*!
+     * Read-only view of contiguous arithmetic values
+     * @note When deserialized, view points directly into serialized data if it is suitably aligned and has host byte
+     * order, otherwise values are copied into storage owned by the view
+     * @tparam T Arithmetic or enum value type
+     */
+    template<class T>
+    class ArrayView
     {
-    private:
-        template<class C>
-        static constexpr auto
-        test(int) -> decltype(ldeclval<C>().insert(ldeclval<C>().end(), *ldeclval<C>().begin()), std::true_type());
+    public:
+        typedef T value_type;
+        typedef size_t size_type;
+        typedef const T *const_iterator;
+        typedef const T *iterator;
 
-        template<class>
-        static constexpr std::false_type test(...);
+        ArrayView() : ptr(nullptr), length(0) {}
 
-    public:
-        static constexpr bool value = decltype(test<T>(0))::value;
-    };
+        //! Create view of external data
+        ArrayView(const T *ptr, size_t length) : ptr(ptr), length(length) {}
 
-    template<class T>
-    struct is_insertable<T, std::enable_if_t<!std::is_class_v<T>>>
-    {
-        static constexpr bool value = false;
-    };
+        //! Create view owning it's data
+        explicit ArrayView(std::vector<T> &&data) : storage(std::move(data)), ptr(storage.data()), length(storage.size()) {}
 
-    template<class T>
-    static constexpr bool is_insertable_v = is_insertable<T>::value;
+        ArrayView(const ArrayView &other) : storage(other.storage), ptr(other.owning() ? storage.data() : other.ptr),
+                                            length(other.length) {}
 
-#pragma GCC diagnostic pop
+        ArrayView(ArrayView &&other) noexcept = default;
 
-    template<class T, template<class, size_t> class Ref>
-    struct is_std_array : std::false_type
-    {
-    };
+        ArrayView &operator=(const ArrayView &other)
+        {
+            if (this != &other)
+            {
+                storage = other.storage;
+                ptr = other.owning() ? storage.data() : other.ptr;
+                length = other.length;
+            }
+            return *this;
+        }
 
-    template<template<class, size_t> class Ref, class T, size_t size>
-    struct is_std_array<Ref<T, size>, Ref> : std::true_type
-    {
-    };
+        ArrayView &operator=(ArrayView &&other) noexcept = default;
 
-    template<class T>
-    static constexpr bool is_std_array_v = is_std_array<T, std::array>::value;
+        const T *data() const
+        { return ptr; }
 
-    template<class T>
-    struct is_forward_list : std::false_type {};
+        size_t size() const
+        { return length; }
 
-    template<class T>
-    struct is_forward_list<std::forward_list<T>> : std::true_type {};
+        bool empty() const
+        { return length == 0; }
 
-    template<class T>
-    static constexpr bool is_forward_list_v = is_forward_list<T>::value;
+        const T *begin() const
+        { return ptr; }
 
-    template<class T, size_t i = tuple_size_v<T> - 1>
-    struct tuple_has_const
-    {
-        static constexpr bool value = std::is_const_v<tuple_element_t<T, i>> || tuple_has_const<T, i - 1>::value;
-    };
+        const T *end() const
+        { return ptr + length; }
 
-    template<class T>
-    struct tuple_has_const<T, 0>
-    {
-        static constexpr bool value = std::is_const_v<tuple_element_t<T, 0>>;
-    };
+        const T &operator[](size_t i) const
+        { return ptr[i]; }
 
-    template<class T>
-    static constexpr bool tuple_has_const_v = tuple_has_const<T>::value;
+        //! Check if view owns it's data instead of pointing to external memory
+        bool owning() const
+        { return !storage.empty(); }
 
-    template<class T, class sizeT1>
-    struct size_type
-    {
-        static_assert(std::is_integral_v<plain_value<T>>, "Container size must be integral");
-        static_assert(std::is_integral_v<sizeT1>, "Template size type must be integral or void");
-        static_assert(sizeof(sizeT1) >= sizeof(plain_value<T>),
-                      "Template size type can't be smaller than container size type");
-        typedef sizeT1 type;
-    };
+#if defined(__cpp_lib_span)
+        operator std::span<const T>() const
+        { return {ptr, length}; }
+#endif
 
-    template<class T>
-    struct size_type<T, void>
-    {
-        typedef plain_value<T> type;
+    private:
+        std::vector<T> storage;
+        const T *ptr;
+        size_t length;
     };
 
-    template<class T>
-    using size_type_t = typename size_type<T, sizeT>::type;
-
-    template<class T, ByteOrder from, ByteOrder to>
-    static constexpr plain_value<T> reorder(plain_value<T> val)
+    /*!
+     * Serialization output which appends data to the end of a contiguous container, growing it geometrically
+     * @tparam Container Container of chars (e.g. std::vector<char> or std::string)
+     * @note Containers with DefaultInitAllocator (e.g. Serialization::Buffer) are resized ahead of written data,
+     * other containers are inserted into, so the grown part is never zero filled before it's written
+     */
+    template<class Container>
+    class ContainerOutput
     {
-        static_assert(std::is_arithmetic_v<plain_value<T>>);
-        if constexpr(from != to && sizeof(plain_value<T>) > 1)
+    public:
+        explicit ContainerOutput(Container &container) : container(container), pos(std::size(container))
         {
-            plain_value<T> ret = 0;
-            for (size_t i = 0; i < sizeof(val); ++i)
+            if constexpr (!resized)
             {
-                ret = plain_value<T>(ret << 8);
-                ret |= val & 0xFF;
-                val = plain_value<T>(val >> 8);
+                if (container.capacity() < minSize)
+                {
+                    container.reserve(minSize);
+                }
             }
-            return ret;
         }
-        else
+
+        void put(const void *src, size_t size)
         {
-            return val;
+            if constexpr (resized)
+            {
+                if (std::size(container) - pos < size)
+                {
+                    grow(size);
+                }
+                memcpy(std::data(container) + pos, src, size);
+            }
+            else
+            {
+                auto ptr = static_cast<const char *>(src);
+                container.insert(std::end(container), ptr, ptr + size);
+            }
+            pos += size;
         }
-    }
 
-    static constexpr ValueType typePriority[] = {Optimized,
-                                                 Arithmetic,
-                                                 Enum,
-                                                 ArithmeticArray,
-                                                 ArithmeticContiguous,
-                                                 Array,
-                                                 Tuple,
-                                                 Iterable,
-                                                 NonSerializable};
+        //! Shrink container to the data written so far
+        void finish()
+        {
+            container.resize(pos);
+        }
 
-    template<class T, ValueType tag, class = void>
-    struct qualifies : public std::false_type
-    {
-    };
+    private:
+        static constexpr bool resized = is_default_init_allocated_v<Container>;
 
-    template<class T, ValueType tag>
-    static constexpr bool qualifies_v = qualifies<T, tag>::value;
+        static constexpr size_t minSize = 64;
 
-    template<class T>
-    struct qualifies<T, Optimized,
-            std::enable_if_t<is_std_array_v<T> &&
-                             (qualifies_v<std::remove_pointer_t<decltype(std::data(ldeclval<T>()))>, Arithmetic> ||
-                              qualifies_v<std::remove_pointer_t<decltype(std::data(
-                                      ldeclval<T>()))>, ArithmeticArray>) &&
-                             order == Host>>
-            : public std::true_type
-    {
-    };
+        void grow(size_t size)
+        {
+            auto newSize = std::size(container) * 2;
+            if (newSize < pos + size)
+            {
+                newSize = pos + size;
+            }
+            container.resize(newSize < minSize ? minSize : newSize);
+        }
 
-    template<class T>
-    struct qualifies<T, Optimized, std::enable_if_t<is_forward_list_v<T>>> : public std::true_type
-    {
+        Container &container;
+        size_t pos;
     };
 
-    template<class T>
-    struct qualifies<T, Arithmetic, std::enable_if_t<std::is_arithmetic_v<plain_value<T>>>> : public std::true_type
+    /*!
+     * Serialization output into a memory chunk of limited capacity
+     * @note Data which does not fit is dropped, but it's size is still counted
+     */
+    class BoundedOutput
     {
-    };
+    public:
+        BoundedOutput(char *ptr, size_t capacity) : ptr(ptr), capacity(capacity), pos(0) {}
 
-    template<class T>
-    struct qualifies<T, Enum, std::enable_if_t<std::is_enum_v<plain_value<T>>>> : public std::true_type
-    {
-    };
+        void put(const void *src, size_t size)
+        {
+            if (pos <= capacity && capacity - pos >= size)
+            {
+                memcpy(ptr + pos, src, size);
+            }
+            pos += size;
+        }
 
-    template<class T>
-    struct qualifies<T, ArithmeticArray,
-            std::enable_if_t<std::is_array_v<plain_value<T>> &&
-                             std::is_integral_v<decltype(std::rank_v<plain_value<T>>)> &&
-                             (std::rank_v<plain_value<T>> > 0) &&
-                             (std::extent_v<plain_value<T>> > 0) &&
-                             (qualifies_v<std::remove_extent_t<plain_value<T>>, Arithmetic> ||
-                              qualifies_v<std::remove_extent_t<plain_value<T>>, ArithmeticArray> ||
-                              qualifies_v<std::remove_extent_t<plain_value<T>>, Enum>) &&
-                             order == Host>>
-            : public std::true_type
-    {
-    };
+        //! Size required to fit all the data written so far
+        size_t size() const
+        {
+            return pos;
+        }
 
-    template<class T>
-    struct qualifies<T, ArithmeticContiguous,
-            std::enable_if_t<std::is_convertible_v<decltype(std::data(ldeclval<plain_value<T>>())), void *> &&
-                             std::is_integral_v<decltype(std::size(ldeclval<plain_value<T>>()))> &&
-                             (qualifies_v<std::remove_pointer_t<decltype(std::data(
-                                     ldeclval<plain_value<T>>()))>, Arithmetic> ||
-                              qualifies_v<std::remove_pointer_t<decltype(std::data(
-                                      ldeclval<plain_value<T>>()))>, Enum>) &&
-                             is_resizable_v<plain_value<T>> &&
-                             order == Host>>
-            : public std::true_type
-    {
-    };
+        //! Check if all the data written so far fits into memory chunk
+        bool overflow() const
+        {
+            return pos > capacity;
+        }
 
-    template<class T>
-    struct qualifies<T, Array,
-            std::enable_if_t<std::is_array_v<plain_value<T>> &&
-                             std::is_integral_v<decltype(std::rank_v<plain_value<T>>)> &&
-                             (std::rank_v<plain_value<T>> > 0) &&
-                             (std::extent_v<plain_value<T>> > 0)>>
-            : public std::true_type
-    {
+    private:
+        char *ptr;
+        size_t capacity;
+        size_t pos;
     };
 
-    template<class T>
-    struct qualifies<T, Tuple, std::enable_if_t<is_tuple_serializable_v<T>>> : public std::true_type
-    {
-    };
+    //! Size of internal buffers of stream outputs and inputs
+    static constexpr size_t streamBufferSize = size_t(64) << 10;
 
-    template<class T>
-    struct qualifies<T, Iterable,
-            std::enable_if_t<std::is_base_of_v<std::input_iterator_tag,
-                    typename std::iterator_traits<decltype(std::begin(
-                            ldeclval<plain_value<T>>()))>::iterator_category> &&
-                             std::is_base_of_v<std::input_iterator_tag,
-                                     typename std::iterator_traits<decltype(std::end(
-                                             ldeclval<plain_value<T>>()))>::iterator_category> &&
-                             is_insertable_v<plain_value<T>> && has_size_v<plain_value<T>> &&
-                             !std::is_same_v<std::vector<bool>, T>>>
-            : public std::true_type
+    /*!
+     * Serialization output which accumulates data in a fixed size buffer and passes it to a sink when it's full
+     * @tparam Sink Callable with signature void(const char *data, size_t size), which consumes the whole data
+     * @note Chunks bigger than the buffer are passed to the sink directly, without copying
+     */
+    template<class Sink>
+    class StreamOutput
     {
-    };
+    public:
+        explicit StreamOutput(Sink sink, size_t capacity = streamBufferSize) : sink(std::move(sink)), buffer(capacity),
+                                                                                pos(0) {}
 
-    template<class T>
-    struct qualifies<T, NonSerializable> : public std::true_type
-    {
+        void put(const void *src, size_t size)
+        {
+            if (buffer.size() - pos >= size)
+            {
+                memcpy(buffer.data() + pos, src, size);
+                pos += size;
+                return;
+            }
+            flush();
+            if (size >= buffer.size())
+            {
+                sink(static_cast<const char *>(src), size);
+            }
+            else
+            {
+                memcpy(buffer.data(), src, size);
+                pos = size;
+            }
+        }
+
+        //! Pass all the buffered data to the sink
+        void flush()
+        {
+            if (pos > 0)
+            {
+                sink(buffer.data(), pos);
+                pos = 0;
+            }
+        }
+
+    private:
+        Sink sink;
+        Buffer buffer;
+        size_t pos;
     };
 
-    template<class T, size_t i = 0>
-    static constexpr ValueType priority_type()
+#if __has_include(<sys/uio.h>)
+
+    //! Minimal size of contiguous data which GatherOutput references in place instead of copying it
+    static constexpr size_t gatherThreshold = size_t(4) << 10;
+
+    //! Maximal amount of segments passed to a single writev() call
+#if defined(IOV_MAX)
+    static constexpr size_t maxWriteSegments = IOV_MAX;
+#else
+    static constexpr size_t maxWriteSegments = 16;
+#endif
+
+    /*!
+     * Serialization output into a list of segments for scatter-gather writing (e.g. with writev() or sendmsg()),
+     * big contiguous data of serialized values is referenced in place, everything else is copied into a scratch buffer
+     * @note Serialized values must stay alive and unchanged until the segments are written
+     */
+    class GatherOutput
     {
-        if constexpr (i == std::size(typePriority) || qualifies_v<T, typePriority[i]>)
+    public:
+        /*!
+         * Create an empty output
+         * @param threshold Minimal size of contiguous data to be referenced in place
+         */
+        explicit GatherOutput(size_t threshold = gatherThreshold) : threshold(threshold), pos(0), begin(0),
+                                                                    referenced(0) {}
+
+        void put(const void *src, size_t size)
         {
-            return typePriority[i];
+            if (scratch.size() - pos < size)
+            {
+                grow(size);
+            }
+            memcpy(scratch.data() + pos, src, size);
+            pos += size;
         }
-        else
+
+        //! Pass data which outlives the output, it's referenced in place if it's big enough
+        void reference(const void *src, size_t size)
         {
-            return priority_type<T, i + 1>();
+            if (size < threshold)
+            {
+                put(src, size);
+                return;
+            }
+            if (pos > begin)
+            {
+                parts.push_back({nullptr, begin, pos - begin});
+                begin = pos;
+            }
+            parts.push_back({static_cast<const char *>(src), 0, size});
+            referenced += size;
         }
-    }
 
-    //Calculate size
+        //! Segments of all the data written so far, the ones pointing into the scratch buffer are valid until next write
+        std::vector<iovec> segments() const
+        {
+            std::vector<iovec> ret(parts.size() + (pos > begin));
+            for (size_t i = 0; i < parts.size(); ++i)
+            {
+                ret[i].iov_base = const_cast<char *>(parts[i].ptr ? parts[i].ptr : scratch.data() + parts[i].offset);
+                ret[i].iov_len = parts[i].size;
+            }
+            if (pos > begin)
+            {
+                ret.back().iov_base = const_cast<char *>(scratch.data() + begin);
+                ret.back().iov_len = pos - begin;
+            }
+            return ret;
+        }
 
-    template<class T, class = void>
-    struct byte_size
-    {
-        static_assert(priority_type<T>() != NonSerializable, "Value must be serializable");
-    };
+        //! Total size of the data written so far
+        size_t size() const
+        {
+            return pos + referenced;
+        }
 
-    template<class T>
-    static constexpr size_t byte_size_f(const T &val)
-    {
-        return byte_size<T>::get(val);
-    }
+        //! Size of the data referenced in place
+        size_t referencedSize() const
+        {
+            return referenced;
+        }
 
-    template<class T>
-    struct byte_size<T, std::enable_if_t<priority_type<T>() == Optimized && is_std_array_v<T>>>
-    {
-        static constexpr size_t get(const T &val)
+        //! Drop all the segments, keeping the scratch buffer for reuse
+        void clear()
         {
-            return val.size() * sizeof(typename T::value_type);
+            parts.clear();
+            pos = 0;
+            begin = 0;
+            referenced = 0;
         }
-    };
 
-    template<class T>
-    struct byte_size<T, std::enable_if_t<priority_type<T>() == Optimized && is_forward_list_v<T>>>
-    {
-        static constexpr size_t get(const T &val)
+    private:
+        //Referenced data, or a range of the scratch buffer if ptr is nullptr, as it can be reallocated
+        struct Part
         {
-            auto size = sizeof(size_type_t<typename T::size_type>);
-            for (auto &i : val)
+            const char *ptr;
+            size_t offset;
+            size_t size;
+        };
+
+        static constexpr size_t minSize = 64;
+
+        void grow(size_t size)
+        {
+            auto newSize = scratch.size() * 2;
+            if (newSize < pos + size)
             {
-                size += byte_size_f<decltype(i)>(i);
+                newSize = pos + size;
             }
-            return size;
+            scratch.resize(newSize < minSize ? minSize : newSize);
         }
+
+        size_t threshold;
+        Buffer scratch;
+        std::vector<Part> parts;
+        size_t pos;
+        size_t begin;
+        size_t referenced;
     };
 
-    template<class T>
-    struct byte_size<T, std::enable_if_t<priority_type<T>() == Arithmetic>>
+#endif
+
+    //! Deserialization input from a memory chunk
+    class MemoryInput
     {
-        static constexpr size_t get(const T &)
+    public:
+        MemoryInput(const char *ptr, size_t size) : ptr(ptr), rest(size) {}
+
+        void take(void *dst, size_t size)
         {
-            return sizeof(T);
+            memcpy(dst, borrow(size), size);
         }
-    };
 
-    template<class T>
-    struct byte_size<T, std::enable_if_t<priority_type<T>() == Enum>>
-    {
-        static constexpr size_t get(const T &)
+        //! Skip a chunk of data and get a pointer to it, which stays valid as long as the memory chunk
+        const char *borrow(size_t size)
         {
-            return sizeof(T);
+            if (rest < size)
+            {
+                throw DeserializationError("Provided serialized data size is too small");
+            }
+            auto ret = ptr;
+            ptr += size;
+            rest -= size;
+            return ret;
         }
-    };
 
-    template<class T>
-    struct byte_size<T, std::enable_if_t<priority_type<T>() == ArithmeticArray>>
-    {
-        static constexpr size_t get(const T &val)
+        //! Get a pointer to a chunk of data without skipping it, nullptr if there is not enough data
+        const char *peek(size_t size) const
         {
-            return std::extent_v<T> * byte_size_f(val[0]);
+            return rest >= size ? ptr : nullptr;
         }
-    };
 
-    template<class T>
-    struct byte_size<T, std::enable_if_t<priority_type<T>() == ArithmeticContiguous>>
-    {
-        static constexpr size_t get(const T &val)
+        //! Skip a chunk of data previously checked by peek()
+        void skip(size_t size)
         {
-            return sizeof(size_type_t<decltype(std::size(val))>) +
-                   std::size(val) * sizeof(std::remove_pointer_t<decltype(std::data(val))>);
+            ptr += size;
+            rest -= size;
         }
+
+        //! Size of the data left
+        size_t available() const
+        {
+            return rest;
+        }
+
+    private:
+        const char *ptr;
+        size_t rest;
     };
 
-    template<class T>
-    struct byte_size<T, std::enable_if_t<priority_type<T>() == Array>>
+    /*!
+     * Deserialization input from a sequence of memory chunks, e.g. network packets or parts of a ring buffer
+     * @tparam Iterator Iterator over segments, either iovec structures or contiguous containers of chars
+     * (e.g. std::string_view or std::vector<char>)
+     * @note Data within a single segment is borrowed without copying, data crossing segment boundaries is copied
+     */
+    template<class Iterator>
+    class SegmentedInput
     {
-        static constexpr size_t get(const T &val)
+    public:
+        SegmentedInput(Iterator begin, Iterator end) : next(begin), end(end), ptr(nullptr), current(0), rest(0)
         {
-            size_t size = 0;
-            for (auto &i : val)
+            for (auto it = begin; it != end; ++it)
             {
-                size += byte_size_f(i);
+                rest += span(*it).second;
             }
-            return size;
+            advance();
         }
-    };
 
-    template<class T, size_t i = 0>
-    static constexpr size_t tuple_byte_size(const T &val)
-    {
-        if constexpr (i + 1 == tuple_size_v<T>)
+        void take(void *dst, size_t size)
         {
-            return byte_size_f(tuple_get_f<T, i>(val));
+            if (current >= size)
+            {
+                memcpy(dst, ptr, size);
+                skip(size);
+                return;
+            }
+            if (rest < size)
+            {
+                throw DeserializationError("Provided serialized data size is too small");
+            }
+            auto out = static_cast<char *>(dst);
+            while (size > 0)
+            {
+                auto chunk = current < size ? current : size;
+                memcpy(out, ptr, chunk);
+                out += chunk;
+                size -= chunk;
+                skip(chunk);
+            }
         }
-        else
+
+        //! Skip a chunk of data and get a pointer to it if it's within a single segment, nullptr otherwise
+        const char *borrow(size_t size)
         {
-            return byte_size_f(tuple_get_f<T, i>(val)) + tuple_byte_size<T, i + 1>(val);
+            if (current < size)
+            {
+                return nullptr;
+            }
+            auto ret = ptr;
+            skip(size);
+            return ret;
         }
-    }
 
-    template<class T>
-    struct byte_size<T, std::enable_if_t<priority_type<T>() == Tuple>>
-    {
-        static constexpr size_t get(const T &val)
+        //! Get a pointer to a chunk of data without skipping it, nullptr if it's not within a single segment
+        const char *peek(size_t size) const
         {
-            return tuple_byte_size(val);
+            return current >= size ? ptr : nullptr;
         }
-    };
 
-    template<class T>
-    struct byte_size<T, std::enable_if_t<priority_type<T>() == Iterable>>
-    {
-        static constexpr size_t get(const T &val)
+        //! Skip a chunk of data previously checked by peek()
+        void skip(size_t size)
         {
-            size_t size = sizeof(size_type_t<decltype(std::size(val))>);
-            for (auto &i : val)
+            ptr += size;
+            current -= size;
+            rest -= size;
+            if (current == 0)
             {
-                size += byte_size_f(i);
+                advance();
             }
-            return size;
         }
-    };
 
-    //Calculate size via sizeof
+        //! Size of the data left in all the segments
+        size_t available() const
+        {
+            return rest;
+        }
 
-    template<class T, class = void>
-    struct byte_minsize
-    {
-        static_assert(priority_type<T>() != NonSerializable, "Value must be serializable");
-    };
+    private:
+        template<class Segment>
+        static std::pair<const char *, size_t> span(const Segment &segment)
+        {
+            static_assert(sizeof(*std::data(segment)) == 1, "Segment must be a contiguous container of chars");
+            return {reinterpret_cast<const char *>(std::data(segment)), std::size(segment)};
+        }
 
-    template<class T>
-    static constexpr size_t byte_minsize_v = byte_minsize<T>::value;
+#if __has_include(<sys/uio.h>)
 
-    template<class T>
-    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Optimized && is_std_array_v<T>>>
-    {
-        static constexpr size_t value = byte_minsize_v<T::value_type>()*tuple_size_v<T>;
+        static std::pair<const char *, size_t> span(const iovec &segment)
+        {
+            return {static_cast<const char *>(segment.iov_base), segment.iov_len};
+        }
+
+#endif
+
+        //Move to the next non-empty segment
+        void advance()
+        {
+            while (current == 0 && next != end)
+            {
+                std::tie(ptr, current) = span(*next);
+                ++next;
+            }
+        }
+
+        Iterator next;
+        Iterator end;
+        const char *ptr;
+        size_t current;
+        size_t rest;
     };
 
-    template<class T>
-    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Optimized && is_forward_list_v<T>>>
+    //Sources which can take back data read ahead, with signature void unread(const char *data, size_t size)
+    template<class Source, class = void>
+    struct is_unreadable_source : std::false_type
     {
-        static constexpr size_t value = byte_minsize_v<size_type_t<typename T::size_type>>;
     };
 
-    template<class T>
-    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Arithmetic>>
+    template<class Source>
+    struct is_unreadable_source<Source, std::void_t<decltype(std::declval<Source &>().unread(
+            static_cast<const char *>(nullptr), size_t()))>> : std::true_type
     {
-        static constexpr size_t value = sizeof(T);
     };
 
-    template<class T>
-    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Enum>>
-    {
-        static constexpr size_t value = sizeof(T);
-    };
-
-    template<class T>
-    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == ArithmeticArray>>
-    {
-        static constexpr size_t value = std::extent_v<T> * byte_minsize_v<std::remove_extent_t<T>>;
-    };
-
-    template<class T>
-    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == ArithmeticContiguous>>
-    {
-        static constexpr size_t value = byte_minsize_v<size_type_t<decltype(std::size(std::declval<T>()))>>;
-    };
-
-    template<class T>
-    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Array>>
-    {
-        static constexpr size_t value = std::extent_v<T> * byte_minsize_v<std::remove_extent_t<T>>;
-    };
-
-    template<class T, size_t i = 0>
-    static constexpr size_t tuple_byte_minsize()
-    {
-        if constexpr (i + 1 == tuple_size_v<T>)
-        {
-            return byte_minsize_v<tuple_element_t<T, tuple_size_v<T> - 1>>;
-        }
-        else
-        {
-            return byte_minsize_v<tuple_element_t<T, i>> + tuple_byte_minsize<T, i + 1>();
-        }
-    }
-
-    template<class T>
-    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Tuple>>
-    {
-        static constexpr size_t value =  tuple_byte_minsize<T>();
-    };
-
-    template<class T>
-    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Iterable>>
+    /*!
+     * Deserialization input which reads data from a source through a fixed size buffer
+     * @tparam Source Callable with signature size_t(char *data, size_t size), which reads up to size bytes and returns
+     * their amount, 0 means the end of data
+     * @note Source is read ahead by up to the buffer size, if it has a member void unread(const char *data,
+     * size_t size), data which was read ahead but not used is passed back to it when input is destroyed
+     * @note Capacity of 0 disables read ahead, so data is read from the source exactly as it's used
+     */
+    template<class Source>
+    class StreamInput
     {
-        static constexpr size_t value = byte_minsize_v<size_type_t<decltype(std::size(std::declval<T>()))>>;
-    };
-
-    //Append
+    public:
+        explicit StreamInput(Source source, size_t capacity = streamBufferSize) : source(std::move(source)),
+                                                                                  buffer(capacity), pos(0), end(0) {}
 
-    template<class T, class = void>
-    struct append
-    {
-        static_assert(priority_type<T>() != NonSerializable, "Value must be serializable");
-    };
+        StreamInput(const StreamInput &) = delete;
 
-    template<class T>
-    static constexpr void append_f(char *&ptr, const T &val)
-    {
-        return append<T>::get(ptr, val);
-    }
+        StreamInput &operator=(const StreamInput &) = delete;
 
-    template<class T>
-    struct append<T, std::enable_if_t<priority_type<T>() == Optimized && is_std_array_v<T>>>
-    {
-        static constexpr void get(char *&ptr, const T &val)
+        ~StreamInput()
         {
-            static_assert(order == Host);
-            auto size = byte_size_f(val);
-            memcpy(ptr, std::data(val), size);
-            ptr += size;
+            if constexpr (is_unreadable_source<Source>::value)
+            {
+                if (pos < end)
+                {
+                    try
+                    {
+                        source.unread(buffer.data() + pos, end - pos);
+                    }
+                    catch (...)
+                    {
+                    }
+                }
+            }
         }
-    };
 
-    template<class T>
-    struct append<T, std::enable_if_t<priority_type<T>() == Optimized && is_forward_list_v<T>>>
-    {
-        static constexpr void get(char *&ptr, const T &val)
+        void take(void *dst, size_t size)
         {
-            auto size = static_cast<size_type_t<typename T::size_type>>(std::distance(val.begin(), val.end()));
-            append_f(ptr, size);
-            for (auto &i : val)
+            if (end - pos >= size)
+            {
+                if (size > 0)
+                {
+                    memcpy(dst, buffer.data() + pos, size);
+                    pos += size;
+                }
+                return;
+            }
+            auto out = static_cast<char *>(dst);
+            if (end > pos)
+            {
+                memcpy(out, buffer.data() + pos, end - pos);
+                out += end - pos;
+                size -= end - pos;
+            }
+            pos = end = 0;
+            if (size >= buffer.size())
             {
-                append_f(ptr, i);
+                fill(out, size);
+                return;
             }
+            end = fill(buffer.data(), size, buffer.size());
+            memcpy(out, buffer.data(), size);
+            pos = size;
         }
-    };
 
-    template<class T>
-    struct append<T, std::enable_if_t<priority_type<T>() == Arithmetic>>
-    {
-        static constexpr void get(char *&ptr, const T &val)
+        //! Data is not kept in memory, so it can't be borrowed
+        const char *borrow(size_t)
         {
-            auto ordval = reorder<decltype(val), Host, order>(val);
-            memcpy(ptr, &ordval, sizeof(ordval));
-            ptr += sizeof(ordval);
+            return nullptr;
         }
-    };
 
-    template<class T>
-    struct append<T, std::enable_if_t<priority_type<T>() == Enum>>
-    {
-        static constexpr void get(char *&ptr, const T &val)
+        //! Get a pointer to a chunk of buffered data without skipping it, nullptr if not enough data is buffered
+        const char *peek(size_t size) const
         {
-            append_f(ptr, *reinterpret_cast<const std::underlying_type_t<plain_value<T>> *>(&val));
+            return end - pos >= size ? buffer.data() + pos : nullptr;
         }
-    };
 
-    template<class T>
-    struct append<T, std::enable_if_t<priority_type<T>() == ArithmeticArray>>
-    {
-        static constexpr void get(char *&ptr, const T &val)
+        //! Skip a chunk of data previously checked by peek()
+        void skip(size_t size)
         {
-            static_assert(order == Host);
-            auto size = byte_size_f(val);
-            memcpy(ptr, val, size);
-            ptr += size;
+            pos += size;
         }
-    };
 
-    template<class T>
-    struct append<T, std::enable_if_t<priority_type<T>() == ArithmeticContiguous>>
-    {
-        static constexpr void get(char *&ptr, const T &val)
+        //! Size of the data left is unknown
+        size_t available() const
         {
-            static_assert(order == Host);
-            auto size = static_cast<size_type_t<decltype(std::size(val))>>(std::size(val));
-            append_f(ptr, size);
-            memcpy(ptr, std::data(val), size * sizeof(std::remove_pointer_t<decltype(std::data(val))>));
-            ptr += size * sizeof(std::remove_pointer_t<decltype(std::data(val))>);
+            return std::numeric_limits<size_t>::max();
         }
-    };
 
-    template<class T>
-    struct append<T, std::enable_if_t<priority_type<T>() == Array>>
-    {
-        static constexpr void get(char *&ptr, const T &val)
+    private:
+        size_t fill(char *dst, size_t size, size_t capacity = 0)
         {
-            for (auto &i : val)
+            size_t done = 0;
+            while (done < size)
             {
-                append_f(ptr, i);
+                auto current = source(dst + done, (capacity > size ? capacity : size) - done);
+                if (current == 0)
+                {
+                    throw DeserializationError("Provided serialized data size is too small");
+                }
+                done += current;
             }
+            return done;
         }
+
+        Source source;
+        Buffer buffer;
+        size_t pos;
+        size_t end;
     };
 
-    template<class T, size_t i = 0>
-    static void append_tuple(char *&ptr, const T &val)
+    //! Sink writing to std::ostream
+    struct OstreamSink
     {
-        append_f(ptr, tuple_get_f<T, i>(val));
-        if constexpr (i + 1 < tuple_size_v<T>)
-        {
-            append_tuple<T, i + 1>(ptr, val);
-        }
-    }
+        std::ostream &stream;
 
-    template<class T>
-    struct append<T, std::enable_if_t<priority_type<T>() == Tuple>>
-    {
-        static constexpr void get(char *&ptr, const T &val)
+        void operator()(const char *data, size_t size)
         {
-            append_tuple(ptr, val);
+            if (!stream.write(data, std::streamsize(size)))
+            {
+                throw std::ios_base::failure("Failed to write serialized data to the stream");
+            }
         }
     };
 
-    template<class T>
-    struct append<T, std::enable_if_t<priority_type<T>() == Iterable>>
+    //! Source reading from std::istream
+    struct IstreamSource
     {
-        static constexpr void get(char *&ptr, const T &val)
+        std::istream &stream;
+
+        size_t operator()(char *data, size_t size)
         {
-            append_f(ptr, static_cast<size_type_t<decltype(std::size(val))>>(std::size(val)));
-            for (auto i = std::begin(val); i != std::end(val); ++i)
+            stream.read(data, std::streamsize(size));
+            if (stream.bad())
             {
-                append_f(ptr, *i);
+                throw std::ios_base::failure("Failed to read serialized data from the stream");
             }
+            return size_t(stream.gcount());
         }
-    };
-
-    // Take
 
-    static void check_size(size_t &sizeLeft, size_t currentSize)
-    {
-        if (sizeLeft < currentSize)
+        //! Return data read ahead to the stream by seeking back, or by putting it back if stream can't seek
+        void unread(const char *data, size_t size)
         {
-            throw Serialization::DeserializationError("Provided serialized data size is too small");
+            //Reading ahead may have hit the end of the stream, which is not reached anymore
+            stream.clear(stream.rdstate() & ~(std::ios_base::eofbit | std::ios_base::failbit));
+            auto buf = stream.rdbuf();
+            if (buf->pubseekoff(-std::streamoff(size), std::ios_base::cur, std::ios_base::in) != std::streampos(-1))
+            {
+                return;
+            }
+            for (; size > 0; --size)
+            {
+                if (buf->sputbackc(data[size - 1]) == std::istream::traits_type::eof())
+                {
+                    stream.setstate(std::ios_base::failbit);
+                    return;
+                }
+            }
         }
-        sizeLeft -= currentSize;
-    }
-
-    template<class T, class = void>
-    struct take
-    {
-        static_assert(priority_type<T>() != NonSerializable, "Value must be serializable");
     };
 
-    template<class T>
-    static plain_value<T> take_f(const char *&ptr, size_t &restSize)
-    {
-        static_assert(!take<T>::useReference, "This value can only be assigned by reference");
-        return take<T>::get(ptr, restSize);
-    }
+    //! Size of uncompressed blocks of compressed outputs
+    static constexpr size_t compressedBlockSize = streamBufferSize;
 
-    template<class T>
-    static void take_f(const char *&ptr, size_t &restSize, plain_value<T> &val)
+    /*!
+     * LZ4-style block compressor without external dependencies
+     * @note Block is a sequence of literals followed by a match with an offset of up to 64 KiB into already decoded
+     * data, so blocks of up to compressedBlockSize bytes are compressed and decompressed independently
+     */
+    class BlockCodec
     {
-        static_assert(take<T>::useReference, "This value can not be assigned by reference");
-        take<T>::get(ptr, restSize, val);
-    }
+    public:
+        //! Size of a block frame header: little endian 32 bit uncompressed size and stored size
+        static constexpr size_t headerSize = 8;
 
-    template<class T>
-    struct take<T, std::enable_if_t<priority_type<T>() == Optimized && is_std_array_v<T>>>
-    {
-        static constexpr bool useReference = true;
+        //! Flag of a stored size of a block which is kept uncompressed
+        static constexpr uint32_t rawFlag = uint32_t(1) << 31;
 
-        static constexpr void get(const char *&ptr, size_t &restSize, plain_value<T> &val)
+        //! Maximal size of compressed data of a chunk
+        static constexpr size_t bound(size_t size)
         {
-            static_assert(order == Host);
-            auto size = byte_size_f(val);
-            check_size(restSize, size);
-            memcpy(std::data(val), ptr, val.size() * sizeof(typename T::value_type));
-            ptr += size;
+            return size + size / 255 + 16;
         }
-    };
-
-    template<class T>
-    struct take<T, std::enable_if_t<priority_type<T>() == Optimized && is_forward_list_v<T>>>
-    {
-        static constexpr bool useReference = true;
 
-        static constexpr void get(const char *&ptr, size_t &restSize, plain_value<T> &val)
+        /*!
+         * Compress a chunk of data
+         * @param src Data to compress
+         * @param size Size of data, at most compressedBlockSize
+         * @param dst Output of at least bound(size) bytes
+         * @return Size of compressed data
+         */
+        static size_t compress(const char *src, size_t size, char *dst)
         {
-            size_type_t<typename plain_value<T>::size_type> size;
-            if constexpr(take<typename T::size_type>::useReference)
+            uint16_t table[hashSize] = {};
+            auto op = dst;
+            size_t anchor = 0;
+            if (size > minBlockSize)
             {
-                take_f<decltype(size)>(ptr, restSize, size);
-            }
-            else
-            {
-                size = take_f<decltype(size)>(ptr, restSize);
-            }
-            if(size*byte_minsize_v<typename plain_value<T>::value_type> > restSize)
-            {
-                throw Serialization::DeserializationError("Provided serialized data size is too small");
+                auto matchLimit = size - lastLiterals;
+                size_t i = 1;
+                while (i < size - minBlockSize)
+                {
+                    auto cur = load32(src + i);
+                    auto &entry = table[hash(cur)];
+                    size_t candidate = entry;
+                    entry = uint16_t(i);
+                    if (candidate >= i || load32(src + candidate) != cur)
+                    {
+                        //Skip faster through data which doesn't compress
+                        i += 1 + ((i - anchor) >> 6);
+                        continue;
+                    }
+                    auto length = minMatch;
+                    while (i + length + 8 <= matchLimit && load64(src + candidate + length) == load64(src + i + length))
+                    {
+                        length += 8;
+                    }
+                    while (i + length < matchLimit && src[candidate + length] == src[i + length])
+                    {
+                        ++length;
+                    }
+                    op = put_sequence(op, src + anchor, i - anchor, i - candidate, length);
+                    i += length;
+                    anchor = i;
+                }
             }
-            auto it = val.before_begin();
-            for (size_t i = 0; i < size; ++i)
+            return size_t(put_sequence(op, src + anchor, size - anchor, 0, 0) - dst);
+        }
+
+        /*!
+         * Decompress a chunk of data
+         * @param src Compressed data
+         * @param size Size of compressed data
+         * @param dst Output of size bytes
+         * @param dstSize Exact size of decompressed data
+         * @throw DeserializationError if compressed data is malformed
+         */
+        static void decompress(const char *src, size_t size, char *dst, size_t dstSize)
+        {
+            auto ip = reinterpret_cast<const uint8_t *>(src);
+            auto ipEnd = ip + size;
+            auto op = dst;
+            auto opEnd = dst + dstSize;
+            while (true)
             {
-                if constexpr (take<typename plain_value<T>::value_type>::useReference)
+                if (ip == ipEnd)
                 {
-                    typename plain_value<T>::value_type el;
-                    take_f<typename plain_value<T>::value_type>(ptr, restSize, el);
-                    it = val.insert_after(it, std::move(el));
+                    throw DeserializationError("Compressed block is truncated");
+                }
+                auto token = *ip++;
+                auto literals = take_length(ip, ipEnd, size_t(token >> 4));
+                if (size_t(ipEnd - ip) < literals || size_t(opEnd - op) < literals)
+                {
+                    throw DeserializationError("Compressed block literals are out of bounds");
+                }
+                if (literals <= wildCopySize && size_t(ipEnd - ip) >= wildCopySize && size_t(opEnd - op) >= wildCopySize)
+                {
+                    //Copy a fixed size chunk, bytes beyond literals are overwritten later
+                    memcpy(op, ip, wildCopySize);
                 }
                 else
                 {
-                    it = val.insert_after(it, take_f<typename plain_value<T>::value_type>(ptr, restSize));
+                    memcpy(op, ip, literals);
+                }
+                ip += literals;
+                op += literals;
+                if (ip == ipEnd)
+                {
+                    break;
+                }
+                if (ipEnd - ip < 2)
+                {
+                    throw DeserializationError("Compressed block is truncated");
+                }
+                auto offset = size_t(ip[0]) | size_t(ip[1]) << 8;
+                ip += 2;
+                auto length = take_length(ip, ipEnd, size_t(token & 15)) + minMatch;
+                if (offset == 0 || size_t(op - dst) < offset || size_t(opEnd - op) < length)
+                {
+                    throw DeserializationError("Compressed block match is out of bounds");
                 }
+                auto match = op - offset;
+                if (offset >= 8 && size_t(opEnd - op) >= length + 8)
+                {
+                    auto matchEnd = op + length;
+                    for (; op < matchEnd; op += 8, match += 8)
+                    {
+                        memcpy(op, match, 8);
+                    }
+                    op = matchEnd;
+                    continue;
+                }
+                //Overlapping match repeats it's period, so copy in chunks doubling with the distance from the source
+                while (length > 0)
+                {
+                    auto chunk = std::min(size_t(op - match), length);
+                    memcpy(op, match, chunk);
+                    op += chunk;
+                    length -= chunk;
+                }
+            }
+            if (op != opEnd)
+            {
+                throw DeserializationError("Compressed block size doesn't match it's header");
             }
         }
-    };
-
-    template<class T>
-    struct take<T, std::enable_if_t<priority_type<T>() == Arithmetic>>
-    {
-        static constexpr bool useReference = true;
 
-        static constexpr void get(const char *&ptr, size_t &restSize, plain_value<T> &val)
+    private:
+        static constexpr size_t minMatch = 4;
+        static constexpr size_t lastLiterals = 5;
+        static constexpr size_t minBlockSize = 12;
+        static constexpr size_t hashBits = 12;
+        static constexpr size_t hashSize = size_t(1) << hashBits;
+        static constexpr size_t wildCopySize = 16;
+
+        static uint32_t load32(const char *ptr)
         {
-            plain_value<decltype(val)> nval;
-            check_size(restSize, sizeof(nval));
-            memcpy(&nval, ptr, sizeof(nval));
-            ptr += sizeof(nval);
-            val = reorder<decltype(nval), order, Host>(nval);
+            uint32_t ret;
+            memcpy(&ret, ptr, sizeof(ret));
+            return ret;
         }
-    };
-
-    template<class T>
-    struct take<T, std::enable_if_t<priority_type<T>() == Enum>>
-    {
-        static constexpr bool useReference = true;
 
-        static constexpr void get(const char *&ptr, size_t &restSize, plain_value<T> &val)
+        static uint64_t load64(const char *ptr)
         {
-            take_f<std::underlying_type_t<plain_value<T>>>(ptr, restSize,
-                                                           *reinterpret_cast<std::underlying_type_t<plain_value<T>> *>(&val));
+            uint64_t ret;
+            memcpy(&ret, ptr, sizeof(ret));
+            return ret;
         }
-    };
 
-    template<class T>
-    struct take<T, std::enable_if_t<priority_type<T>() == ArithmeticArray>>
-    {
-        static constexpr bool useReference = true;
+        static size_t hash(uint32_t val)
+        {
+            return (val * 2654435761u) >> (32 - hashBits);
+        }
 
-        static constexpr void get(const char *&ptr, size_t &restSize, plain_value<T> &val)
+        static char *put_length(char *op, size_t length)
         {
-            static_assert(order == Host);
-            auto size = byte_size_f(val);
-            check_size(restSize, size);
-            memcpy(std::data(val), ptr, byte_size_f(val));
-            ptr += size;
+            for (; length >= 255; length -= 255)
+            {
+                *op++ = char(255);
+            }
+            *op++ = char(length);
+            return op;
         }
-    };
 
-    template<class T>
-    struct take<T, std::enable_if_t<priority_type<T>() == ArithmeticContiguous>>
-    {
-        static constexpr bool useReference = true;
+        static size_t take_length(const uint8_t *&ip, const uint8_t *ipEnd, size_t length)
+        {
+            if (length == 15)
+            {
+                uint8_t byte;
+                do
+                {
+                    if (ip == ipEnd)
+                    {
+                        throw DeserializationError("Compressed block is truncated");
+                    }
+                    byte = *ip++;
+                    length += byte;
+                } while (byte == 255);
+            }
+            return length;
+        }
 
-        static constexpr void get(const char *&ptr, size_t &restSize, plain_value<T> &val)
+        //Write literals followed by a match, match of zero length ends the block
+        static char *put_sequence(char *op, const char *literals, size_t count, size_t offset, size_t length)
         {
-            static_assert(order == Host);
-            size_type_t<decltype(std::size(val))> length;
-            if constexpr(take<decltype(std::size(val))>::useReference)
+            auto token = op++;
+            auto matchCode = length ? length - minMatch : 0;
+            *token = char((count < 15 ? count : 15) << 4 | (matchCode < 15 ? matchCode : 15));
+            if (count >= 15)
             {
-                take_f<decltype(length)>(ptr, restSize, length);
+                op = put_length(op, count - 15);
             }
-            else
+            memcpy(op, literals, count);
+            op += count;
+            if (length)
             {
-                length = take_f<size_type_t<decltype(std::size(val))>>(ptr, restSize);
+                *op++ = char(offset);
+                *op++ = char(offset >> 8);
+                if (matchCode >= 15)
+                {
+                    op = put_length(op, matchCode - 15);
+                }
             }
-            auto size = length * sizeof(std::remove_pointer_t<decltype(std::data(val))>);
-            check_size(restSize, size);
-            val.resize(length);
-            memcpy(std::data(val), ptr, std::size(val) * sizeof(std::remove_pointer_t<decltype(std::data(val))>));
-            ptr += size;
+            return op;
         }
     };
 
-    template<class T>
-    struct take<T, std::enable_if_t<priority_type<T>() == Array>>
+    /*!
+     * Serialization output which compresses data in independent blocks of compressedBlockSize bytes and passes them
+     * to an underlying output
+     * @note Each block is preceded by a header of BlockCodec::headerSize bytes with uncompressed and stored sizes, so
+     * blocks can be located and decompressed without decompressing preceding ones, blocks which don't compress are
+     * stored as is
+     * @tparam Out Underlying serialization output
+     */
+    template<class Out>
+    class CompressingOutput
     {
-        static constexpr bool useReference = true;
+    public:
+        explicit CompressingOutput(Out &out) : out(out), block(compressedBlockSize),
+                                               frame(BlockCodec::headerSize + BlockCodec::bound(compressedBlockSize)),
+                                               pos(0) {}
 
-        static constexpr void get(const char *&ptr, size_t &restSize, plain_value<T> &val)
+        void put(const void *src, size_t size)
         {
-            for (auto &i : val)
+            auto ptr = static_cast<const char *>(src);
+            if (block.size() - pos < size)
             {
-                if constexpr (take<decltype(i)>::useReference)
-                {
-                    take_f<decltype(i)>(ptr, restSize, i);
-                }
-                else
+                auto part = block.size() - pos;
+                memcpy(block.data() + pos, ptr, part);
+                pos += part;
+                ptr += part;
+                size -= part;
+                flush();
+                //Compress whole blocks directly from provided data
+                for (; size >= block.size(); ptr += block.size(), size -= block.size())
                 {
-                    i = take_f<decltype(i)>(ptr, restSize);
+                    put_block(ptr, block.size());
                 }
             }
+            memcpy(block.data() + pos, ptr, size);
+            pos += size;
         }
-    };
 
-
-    template<class T, size_t i = 0, class ... Args>
-    static plain_value<T> take_tuple_construct(const char *&ptr, size_t &restSize, Args &... args)
-    {
-        if constexpr (take<plain_value<tuple_element_t<T, i>>>::useReference)
+        //! Compress and pass all the buffered data to the underlying output, ending current block
+        void flush()
         {
-            plain_value<tuple_element_t<T, i>> el;
-            take_f<plain_value<tuple_element_t<T, i>>>(ptr, restSize, el);
-            if constexpr (i + 1 < tuple_size_v<plain_value<T>>)
+            if (pos > 0)
             {
-                return take_tuple_construct<T, i + 1>(ptr, restSize, args..., el);
+                put_block(block.data(), pos);
+                pos = 0;
             }
-            else
+        }
+
+    private:
+        void put_block(const char *src, size_t size)
+        {
+            auto data = frame.data() + BlockCodec::headerSize;
+            auto stored = BlockCodec::compress(src, size, data);
+            auto storedCode = uint32_t(stored);
+            if (stored >= size)
             {
-                return {args..., el};
+                memcpy(data, src, size);
+                stored = size;
+                storedCode = uint32_t(size) | BlockCodec::rawFlag;
             }
+            for (size_t i = 0; i < 4; ++i)
+            {
+                frame[i] = char(size >> (8 * i));
+                frame[4 + i] = char(storedCode >> (8 * i));
+            }
+            out.put(frame.data(), BlockCodec::headerSize + stored);
         }
-        else
+
+        Out &out;
+        Buffer block;
+        Buffer frame;
+        size_t pos;
+    };
+
+    /*!
+     * Deserialization input which decompresses blocks written by CompressingOutput from an underlying input
+     * @note Decompressed data is not kept in memory, so it can't be borrowed
+     * @tparam In Underlying deserialization input, blocks are decompressed directly from it's memory if it can be
+     * borrowed
+     */
+    template<class In>
+    class DecompressingInput
+    {
+    public:
+        explicit DecompressingInput(In &in) : in(in), block(compressedBlockSize), pos(0), end(0) {}
+
+        void take(void *dst, size_t size)
         {
-            auto el = take_f<plain_value<tuple_element_t<T, i>>>(ptr, restSize);
-            if constexpr (i + 1 < tuple_size_v<plain_value<T>>)
+            auto out = static_cast<char *>(dst);
+            while (end - pos < size)
+            {
+                memcpy(out, block.data() + pos, end - pos);
+                out += end - pos;
+                size -= end - pos;
+                pos = end = 0;
+                auto length = take_header();
+                //Decompress whole blocks directly into the destination
+                if (size >= length)
+                {
+                    take_block(out, length);
+                    out += length;
+                    size -= length;
+                }
+                else
+                {
+                    take_block(block.data(), length);
+                    end = length;
+                }
+            }
+            memcpy(out, block.data() + pos, size);
+            pos += size;
+        }
+
+        //! Data is not kept in memory, so it can't be borrowed
+        const char *borrow(size_t)
+        {
+            return nullptr;
+        }
+
+        //! Get a pointer to a chunk of decompressed data without skipping it, nullptr if not enough data is buffered
+        const char *peek(size_t size) const
+        {
+            return end - pos >= size ? block.data() + pos : nullptr;
+        }
+
+        //! Skip a chunk of data previously checked by peek()
+        void skip(size_t size)
+        {
+            pos += size;
+        }
+
+        //! Size of the data left is unknown until it's decompressed
+        size_t available() const
+        {
+            return std::numeric_limits<size_t>::max();
+        }
+
+    private:
+        size_t take_header()
+        {
+            unsigned char header[BlockCodec::headerSize];
+            in.take(header, sizeof(header));
+            uint32_t length = 0;
+            storedCode = 0;
+            for (size_t i = 0; i < 4; ++i)
+            {
+                length |= uint32_t(header[i]) << (8 * i);
+                storedCode |= uint32_t(header[4 + i]) << (8 * i);
+            }
+            if (length == 0 || length > compressedBlockSize)
+            {
+                throw DeserializationError("Compressed block header is malformed");
+            }
+            return length;
+        }
+
+        void take_block(char *dst, size_t length)
+        {
+            bool raw = storedCode & BlockCodec::rawFlag;
+            size_t stored = storedCode & ~BlockCodec::rawFlag;
+            if (raw ? stored != length : stored > BlockCodec::bound(length))
+            {
+                throw DeserializationError("Compressed block header is malformed");
+            }
+            auto src = in.borrow(stored);
+            if (!src)
+            {
+                if (raw)
+                {
+                    in.take(dst, stored);
+                    return;
+                }
+                scratch.resize(BlockCodec::bound(compressedBlockSize));
+                in.take(scratch.data(), stored);
+                src = scratch.data();
+            }
+            if (raw)
             {
-                return take_tuple_construct<T, i + 1>(ptr, restSize, args..., el);
+                memcpy(dst, src, stored);
             }
             else
             {
-                return {args..., el};
+                BlockCodec::decompress(src, stored, dst, length);
             }
         }
 
-    }
+        In &in;
+        Buffer block;
+        Buffer scratch;
+        size_t pos;
+        size_t end;
+        uint32_t storedCode = 0;
+    };
+
+#if __has_include(<unistd.h>)
+
+    //! Sink writing to a POSIX file descriptor
+    struct DescriptorSink
+    {
+        int fd;
+
+        void operator()(const char *data, size_t size)
+        {
+            while (size > 0)
+            {
+                auto written = ::write(fd, data, size);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw std::system_error(errno, std::generic_category(), "Failed to write serialized data");
+                }
+                data += written;
+                size -= size_t(written);
+            }
+        }
+
+#if __has_include(<sys/uio.h>)
+
+        //! Write all the segments with as few system calls as possible, segments are advanced past written data
+        void operator()(iovec *segments, size_t count)
+        {
+            while (count > 0)
+            {
+                auto written = ::writev(fd, segments, int(count < maxWriteSegments ? count : maxWriteSegments));
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw std::system_error(errno, std::generic_category(), "Failed to write serialized data");
+                }
+                auto left = size_t(written);
+                for (; count > 0 && left >= segments->iov_len; ++segments, --count)
+                {
+                    left -= segments->iov_len;
+                }
+                if (left > 0)
+                {
+                    segments->iov_base = static_cast<char *>(segments->iov_base) + left;
+                    segments->iov_len -= left;
+                }
+            }
+        }
+
+#endif
+    };
+
+    //! Source reading from a POSIX file descriptor
+    struct DescriptorSource
+    {
+        int fd;
+
+        size_t operator()(char *data, size_t size)
+        {
+            while (true)
+            {
+                auto count = ::read(fd, data, size);
+                if (count >= 0)
+                {
+                    return size_t(count);
+                }
+                if (errno != EINTR)
+                {
+                    throw std::system_error(errno, std::generic_category(), "Failed to read serialized data");
+                }
+            }
+        }
+
+        //! Return data read ahead to the descriptor by seeking back, data is dropped if descriptor can't seek
+        void unread(const char *, size_t size)
+        {
+            ::lseek(fd, -off_t(size), SEEK_CUR);
+        }
+    };
+
+#endif
+
+#if __has_include(<sys/mman.h>)
+
+    //! Read-only memory mapping of a whole file, advised for sequential access
+    class MappedFile
+    {
+    public:
+        /*!
+         * Map a file
+         * @param path Path to the file
+         * @throw std::system_error if file can't be opened or mapped
+         */
+        explicit MappedFile(const std::string &path) : ptr(nullptr), length(0)
+        {
+            int fd;
+            do
+            {
+                fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            } while (fd < 0 && errno == EINTR);
+            if (fd < 0)
+            {
+                throw std::system_error(errno, std::generic_category(), "Failed to open " + path);
+            }
+            struct stat info {};
+            if (::fstat(fd, &info) != 0)
+            {
+                auto error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "Failed to get size of " + path);
+            }
+            length = size_t(info.st_size);
+            if (length > 0)
+            {
+                auto mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping == MAP_FAILED)
+                {
+                    auto error = errno;
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), "Failed to map " + path);
+                }
+                ptr = static_cast<const char *>(mapping);
+                ::madvise(mapping, length, MADV_SEQUENTIAL);
+            }
+            ::close(fd);
+        }
+
+        MappedFile(MappedFile &&other) noexcept : ptr(other.ptr), length(other.length)
+        {
+            other.ptr = nullptr;
+            other.length = 0;
+        }
+
+        MappedFile &operator=(MappedFile &&other) noexcept
+        {
+            std::swap(ptr, other.ptr);
+            std::swap(length, other.length);
+            return *this;
+        }
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        ~MappedFile()
+        {
+            if (ptr)
+            {
+                ::munmap(const_cast<char *>(ptr), length);
+            }
+        }
+
+        const char *data() const
+        { return ptr; }
+
+        size_t size() const
+        { return length; }
+
+    private:
+        const char *ptr;
+        size_t length;
+    };
+
+#endif
+}
+
+/*!
+ * Variable serializer class
+ * @note Cant be used to serialize arithmetic values, c-style arrays and most of standard c++ containers
+ * @tparam order Serialization byte order
+ * @tparam sizeT Type to represent container size, if void then size type provided by container will be used
+ * @tparam encoding Encoding of integers, variable length integers make data of many small containers or values compact
+ */
+template<ByteOrder order = Host, class sizeT = void, IntegerEncoding encoding = FixedWidth>
+class Serializer
+{
+public:
+
+    //! Type of values recognized by serializer
+    enum ValueType
+    {
+        Optimized,              ///<Type is specifically optimized to be serialized in an efficient way
+        Arithmetic,             ///<Type is arithmetic and will be simply converted to bytes (e.g. int)
+        Enum,                   ///<Type is enum and will be simply converted to bytes
+        ArithmeticArray,        ///<Type is an array of arithmetic values or structs serialized as stored in memory, it will me copied bytewise (e.g. int[4])
+        ArithmeticContiguous,   ///<Type stores arithmetic values or structs serialized as stored in memory contiguously, it's data will me copied bytewise with addition of size (e.g. std::vector<int>)
+        Array,                  ///<Type is an array of custom values, each element will be serialized consequently (e.g. std::string[4])
+        Tuple,                  ///<Type is a tuple of custom values, each element will be serialized consequently (e.g. std::pair<int, int>)
+        Iterable,               ///<Type is an iterable container of custom values, each element will be serialized consequently (e.g. std::vector<std::string>)
+        ArithmeticView,         ///<Type is a read-only view of contiguous arithmetic values, it's serialized as ArithmeticContiguous, but deserialized without copying (e.g. std::string_view)
+        PackedContiguous,       ///<Type stores 16, 32 or 64 bit integers contiguously and Varint encoding is used, values are packed in blocks with their byte lengths (e.g. std::vector<uint32_t>)
+        DeltaPacked,            ///<Type is a container of sorted integers opted in by DELTA_PACKED, differences of values are bitpacked (e.g. std::set<uint64_t>)
+        NonSerializable         ///<Type can not be serialized
+    };
+
+private:
+
+    template<class T>
+    static constexpr bool is_tuple_serializable_v = serializerTuple::is_tuple_serializable_v<T>;
+
+    template<class T>
+    static constexpr size_t tuple_size_v = serializerTuple::tuple_size_v<T>;
+
+    template<class T, size_t i>
+    static auto &tuple_get_f(T &val)
+    { return serializerTuple::tuple_get_f<T, i>(val); }
+
+    template<class T, size_t i>
+    static const auto &tuple_get_f(const T &val)
+    { return serializerTuple::tuple_get_f<T, i>(val); }
+
+    template<class T, size_t i>
+    using tuple_element_t = typename serializerTuple::tuple_element_t<T, i>;
+
+    template<class T>
+    using plain_value = std::remove_cv_t<std::remove_reference_t<T>>;
+
+    template<class T>
+    static constexpr std::add_lvalue_reference_t<T> ldeclval();
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+
+    template<class T>
+    struct is_complete_type
+    {
+    private:
+        template<class C>
+        static constexpr std::true_type test(int(*)[sizeof(C)]);
+
+        template<class>
+        static constexpr std::false_type test(...);
+
+    public:
+        static constexpr bool value = decltype(test<T>(0))::value;
+    };
+
+    template<class T>
+    static constexpr bool is_complete_type_v = is_complete_type<T>::value;
+
+    template<class T, class = void>
+    struct is_resizable
+    {
+    private:
+        template<class C>
+        static constexpr auto
+        test(int) -> decltype(ldeclval<C>().resize(ldeclval<decltype(std::size(ldeclval<C>()))>()), std::true_type());
+
+        template<class>
+        static constexpr std::false_type test(...);
+
+    public:
+        static constexpr bool value = decltype(test<T>(0))::value;
+    };
+
+    template<class T>
+    struct is_resizable<T, std::enable_if_t<!std::is_class_v<T>>>
+    {
+        static constexpr bool value = false;
+    };
+
+    template<class T>
+    static constexpr bool is_resizable_v = is_resizable<T>::value;
+
+    template<class T, class = void>
+    struct is_reservable
+    {
+    private:
+        template<class C>
+        static constexpr auto
+        test(int) -> decltype(ldeclval<C>().reserve(ldeclval<decltype(std::size(ldeclval<C>()))>()), std::true_type());
+
+        template<class>
+        static constexpr std::false_type test(...);
+
+    public:
+        static constexpr bool value = decltype(test<T>(0))::value;
+    };
+
+    template<class T>
+    struct is_reservable<T, std::enable_if_t<!std::is_class_v<T>>>
+    {
+        static constexpr bool value = false;
+    };
+
+    template<class T>
+    static constexpr bool is_reservable_v = is_reservable<T>::value;
+
+    template<class T, class = void>
+    struct is_map : std::false_type
+    {
+    };
+
+    template<class T>
+    struct is_map<T, std::void_t<typename T::key_type, typename T::mapped_type, decltype(ldeclval<T>().emplace_hint(
+            ldeclval<T>().end(), std::declval<typename T::key_type>(), std::declval<typename T::mapped_type>()))>>
+        : std::is_same<typename T::value_type, std::pair<const typename T::key_type, typename T::mapped_type>>
+    {
+    };
+
+    template<class T>
+    static constexpr bool is_map_v = is_map<T>::value;
+
+    template<class T, class = void>
+    struct is_ordered_map : std::false_type
+    {
+    };
+
+    template<class T>
+    struct is_ordered_map<T, std::void_t<typename T::key_compare>> : is_map<T>
+    {
+    };
+
+    template<class T>
+    static constexpr bool is_ordered_map_v = is_ordered_map<T>::value;
+
+    template<class T, class = void>
+    struct has_size
+    {
+    private:
+        template<class C>
+        static constexpr auto test(int) -> decltype(std::enable_if_t<std::is_integral_v<decltype(std::size(
+                ldeclval<C>()))>>(), std::true_type());
+
+        template<class>
+        static constexpr std::false_type test(...);
+
+    public:
+        static constexpr bool value = decltype(test<T>(0))::value;
+    };
+
+    template<class T>
+    static constexpr bool has_size_v = has_size<T>::value;
+
+    template<class T, class = void>
+    struct is_insertable
+    {
+    private:
+        template<class C>
+        static constexpr auto
+        test(int) -> decltype(ldeclval<C>().insert(ldeclval<C>().end(), *ldeclval<C>().begin()), std::true_type());
+
+        template<class>
+        static constexpr std::false_type test(...);
+
+    public:
+        static constexpr bool value = decltype(test<T>(0))::value;
+    };
+
+    template<class T>
+    struct is_insertable<T, std::enable_if_t<!std::is_class_v<T>>>
+    {
+        static constexpr bool value = false;
+    };
+
+    template<class T>
+    static constexpr bool is_insertable_v = is_insertable<T>::value;
+
+    template<class T, class = void>
+    struct is_range_assignable
+    {
+    private:
+        template<class C>
+        static constexpr auto
+        test(int) -> decltype(ldeclval<C>().assign(std::data(ldeclval<C>()), std::data(ldeclval<C>())), std::true_type());
+
+        template<class>
+        static constexpr std::false_type test(...);
+
+    public:
+        static constexpr bool value = decltype(test<T>(0))::value;
+    };
+
+    template<class T>
+    static constexpr bool is_range_assignable_v = is_range_assignable<T>::value;
+
+#pragma GCC diagnostic pop
+
+    //Containers with stateful allocators (e.g. std::pmr::polymorphic_allocator), which must be passed to their new
+    //elements of type V, so nested containers and strings allocate from the same place
+    template<class V, class T, class = void>
+    struct uses_container_allocator : std::false_type
+    {
+    };
+
+    template<class V, class T>
+    struct uses_container_allocator<V, T, std::void_t<typename T::allocator_type,
+            decltype(std::declval<const T &>().get_allocator())>>
+        : std::bool_constant<!std::allocator_traits<typename T::allocator_type>::is_always_equal::value &&
+                             std::uses_allocator_v<V, typename T::allocator_type>>
+    {
+    };
+
+    template<class V, class T>
+    static constexpr bool uses_container_allocator_v = uses_container_allocator<V, T>::value;
+
+    template<class T, template<class, size_t> class Ref>
+    struct is_std_array : std::false_type
+    {
+    };
+
+    template<template<class, size_t> class Ref, class T, size_t size>
+    struct is_std_array<Ref<T, size>, Ref> : std::true_type
+    {
+    };
+
+    template<class T>
+    static constexpr bool is_std_array_v = is_std_array<T, std::array>::value;
+
+    template<class T>
+    struct is_forward_list : std::false_type {};
+
+    template<class T>
+    struct is_forward_list<std::forward_list<T>> : std::true_type {};
+
+    template<class T>
+    static constexpr bool is_forward_list_v = is_forward_list<T>::value;
+
+    template<class T>
+    struct is_view : std::false_type {};
+
+    template<class C, class Traits>
+    struct is_view<std::basic_string_view<C, Traits>> : std::true_type {};
+
+    template<class T>
+    struct is_view<Serialization::ArrayView<T>> : std::true_type {};
+
+#if defined(__cpp_lib_span)
+    template<class T>
+    struct is_view<std::span<const T>> : std::true_type {};
+#endif
+
+    template<class T>
+    static constexpr bool is_view_v = is_view<T>::value;
+
+    template<class T, size_t i = tuple_size_v<T> - 1>
+    struct tuple_has_const
+    {
+        static constexpr bool value = std::is_const_v<tuple_element_t<T, i>> || tuple_has_const<T, i - 1>::value;
+    };
+
+    template<class T>
+    struct tuple_has_const<T, 0>
+    {
+        static constexpr bool value = std::is_const_v<tuple_element_t<T, 0>>;
+    };
+
+    template<class T>
+    static constexpr bool tuple_has_const_v = tuple_has_const<T>::value;
+
+    template<class T, class sizeT1>
+    struct size_type
+    {
+        static_assert(std::is_integral_v<plain_value<T>>, "Container size must be integral");
+        static_assert(std::is_integral_v<sizeT1>, "Template size type must be integral or void");
+        static_assert(sizeof(sizeT1) >= sizeof(plain_value<T>),
+                      "Template size type can't be smaller than container size type");
+        typedef sizeT1 type;
+    };
+
+    template<class T>
+    struct size_type<T, void>
+    {
+        typedef plain_value<T> type;
+    };
+
+    template<class T>
+    using size_type_t = typename size_type<T, sizeT>::type;
+
+    template<size_t size>
+    using uint_of_size_t = std::conditional_t<size == 1, uint8_t,
+                           std::conditional_t<size == 2, uint16_t,
+                           std::conditional_t<size == 4, uint32_t, uint64_t>>>;
+
+    static constexpr size_t maxVarintSize = 10;
+
+    //Integer values written as variable length integers, single byte values gain nothing from it
+    template<class T>
+    static constexpr bool is_varint_v = encoding == Varint && std::is_integral_v<plain_value<T>> &&
+                                        sizeof(plain_value<T>) > 1 && sizeof(plain_value<T>) <= sizeof(uint64_t);
+
+    //Integers of contiguous containers packed in blocks, character types are left for strings
+    template<class T>
+    static constexpr bool is_packable_v = encoding == Varint && std::is_integral_v<plain_value<T>> &&
+                                          (sizeof(plain_value<T>) == 2 || sizeof(plain_value<T>) == 4 ||
+                                           sizeof(plain_value<T>) == 8) &&
+                                          !std::is_same_v<plain_value<T>, wchar_t> &&
+                                          !std::is_same_v<plain_value<T>, char16_t> &&
+                                          !std::is_same_v<plain_value<T>, char32_t>;
+
+    //Types serialized exactly as they are stored in memory, so they can be copied with memcpy: fixed width arithmetic
+    //values in host byte order and arrays of them, trivially copyable custom serializable structs without padding,
+    //which list all their fields in declaration order. Compound values are bytewise only in host byte order, since
+    //in other orders their fields are reordered one by one and not as a whole
+
+    template<class T, class = void>
+    struct is_bytewise : std::false_type
+    {
+    };
+
+    template<class T>
+    static constexpr bool is_bytewise_v = is_bytewise<std::remove_cv_t<T>>::value;
+
+    template<class T, size_t ... i>
+    static constexpr bool tuple_bytewise(std::index_sequence<i...>)
+    {
+        if constexpr (sizeof...(i) > 0 && (serializerTuple::has_tuple_offset_v<T, i> && ...))
+        {
+            constexpr size_t offsets[] = {serializerTuple::tuple_get<T, i>::offset()...};
+            constexpr size_t sizes[] = {sizeof(tuple_element_t<T, i>)...};
+            size_t offset = 0;
+            for (size_t j = 0; j < sizeof...(i); ++j)
+            {
+                if (offsets[j] != offset)
+                {
+                    return false;
+                }
+                offset += sizes[j];
+            }
+            return offset == sizeof(T) && (is_bytewise_v<tuple_element_t<T, i>> && ...);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    template<class T>
+    struct is_bytewise<T, std::enable_if_t<std::is_arithmetic_v<T>>>
+            : std::bool_constant<(order == Host || sizeof(T) == 1) && !is_varint_v<T>>
+    {
+    };
+
+    template<class T>
+    struct is_bytewise<T, std::enable_if_t<std::is_enum_v<T>>> : is_bytewise<std::underlying_type_t<T>>
+    {
+    };
+
+    template<class T>
+    struct is_bytewise<T, std::enable_if_t<std::is_array_v<T> && (std::extent_v<T> > 0)>>
+            : is_bytewise<std::remove_extent_t<T>>
+    {
+    };
+
+    template<class T>
+    struct is_bytewise<T, std::enable_if_t<is_std_array_v<T>>>
+            : std::bool_constant<order == Host && is_bytewise_v<typename T::value_type> &&
+                                 sizeof(T) == sizeof(typename T::value_type) * std::tuple_size_v<T>>
+    {
+    };
+
+    template<class T>
+    struct is_bytewise<T, std::enable_if_t<is_tuple_serializable_v<T> && !serializerTuple::is_std_tuple_v<T> &&
+                                           std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T>>>
+            : std::bool_constant<order == Host && tuple_bytewise<T>(std::make_index_sequence<tuple_size_v<T>>())>
+    {
+    };
+
+    static constexpr size_t bit_width(uint64_t val)
+    {
+#if defined(__GNUC__)
+        return val ? size_t(64 - __builtin_clzll(val)) : 0;
+#else
+        size_t width = 0;
+        for (; val > 0; val >>= 1)
+        {
+            ++width;
+        }
+        return width;
+#endif
+    }
+
+    static constexpr size_t varint_size(uint64_t val)
+    {
+        return (bit_width(val | 1) + 6) / 7;
+    }
+
+    //ZigZag encode signed values, so that values of small magnitude have short encoding
+    template<class T>
+    static constexpr uint64_t to_varint(T val)
+    {
+        if constexpr (std::is_signed_v<T>)
+        {
+            return (uint64_t(int64_t(val)) << 1) ^ uint64_t(int64_t(val) >> 63);
+        }
+        else
+        {
+            return uint64_t(val);
+        }
+    }
+
+    template<class T>
+    static T from_varint(uint64_t val)
+    {
+        if constexpr (std::is_signed_v<T>)
+        {
+            auto decoded = int64_t((val >> 1) ^ (~(val & 1) + 1));
+            if (decoded < int64_t(std::numeric_limits<T>::min()) || decoded > int64_t(std::numeric_limits<T>::max()))
+            {
+                throw Serialization::DeserializationError("Variable length integer is out of range");
+            }
+            return T(decoded);
+        }
+        else
+        {
+            if (val > uint64_t(std::numeric_limits<T>::max()))
+            {
+                throw Serialization::DeserializationError("Variable length integer is out of range");
+            }
+            return T(val);
+        }
+    }
+
+    //Byte size of a container size prefix
+    template<class T>
+    static constexpr size_t size_byte_size(size_t size)
+    {
+        if constexpr (encoding == FixedWidth)
+        {
+            return sizeof(size_type_t<T>);
+        }
+        else
+        {
+            return varint_size(size);
+        }
+    }
+
+    template<class T>
+    static constexpr size_t size_byte_minsize_v = encoding == FixedWidth ? sizeof(size_type_t<T>) : 1;
+
+    template<class T>
+    static constexpr bool is_swappable_size_v = sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8;
+
+    template<class T, ByteOrder from, ByteOrder to>
+    static constexpr plain_value<T> reorder(plain_value<T> val)
+    {
+        typedef plain_value<T> value_type;
+        static_assert(std::is_arithmetic_v<value_type> || from == to);
+        if constexpr (from == to || sizeof(value_type) == 1)
+        {
+            return val;
+        }
+        else if constexpr (std::is_floating_point_v<value_type> && is_swappable_size_v<value_type>)
+        {
+            uint_of_size_t<sizeof(value_type)> bits;
+            memcpy(&bits, &val, sizeof(bits));
+            bits = reorder<decltype(bits), from, to>(bits);
+            memcpy(&val, &bits, sizeof(bits));
+            return val;
+        }
+        else if constexpr (std::is_integral_v<value_type> && is_swappable_size_v<value_type>)
+        {
+#if defined(__cpp_lib_byteswap)
+            return std::byteswap(val);
+#elif defined(__GNUC__)
+            if constexpr (sizeof(value_type) == 2)
+            {
+                return value_type(__builtin_bswap16(uint16_t(val)));
+            }
+            else if constexpr (sizeof(value_type) == 4)
+            {
+                return value_type(__builtin_bswap32(uint32_t(val)));
+            }
+            else
+            {
+                return value_type(__builtin_bswap64(uint64_t(val)));
+            }
+#else
+            value_type ret = 0;
+            for (size_t i = 0; i < sizeof(val); ++i)
+            {
+                ret = value_type(ret << 8);
+                ret |= val & 0xFF;
+                val = value_type(val >> 8);
+            }
+            return ret;
+#endif
+        }
+        else
+        {
+            char bytes[sizeof(value_type)];
+            memcpy(bytes, &val, sizeof(val));
+            for (size_t i = 0; i < sizeof(val) / 2; ++i)
+            {
+                std::swap(bytes[i], bytes[sizeof(val) - 1 - i]);
+            }
+            memcpy(&val, bytes, sizeof(val));
+            return val;
+        }
+    }
+
+    //Shuffle mask reversing bytes of each value of given size within 16 byte lanes
+    template<size_t size>
+    static constexpr std::array<char, 32> reorder_mask()
+    {
+        std::array<char, 32> ret{};
+        for (size_t i = 0; i < ret.size(); ++i)
+        {
+            ret[i] = char(i % 16 - 2 * (i % size) + size - 1);
+        }
+        return ret;
+    }
+
+    //Check if CPU running the code supports AVX2, either known at compile time or detected once at runtime
+    static bool has_avx2()
+    {
+#if defined(__AVX2__)
+        return true;
+#elif defined(SERIALIZER_X86_DISPATCH)
+        static const bool ret = __builtin_cpu_supports("avx2");
+        return ret;
+#else
+        return false;
+#endif
+    }
+
+    //Check if CPU running the code supports SSSE3, either known at compile time or detected once at runtime
+    static bool has_ssse3()
+    {
+#if defined(__SSSE3__)
+        return true;
+#elif defined(SERIALIZER_X86_DISPATCH)
+        static const bool ret = __builtin_cpu_supports("ssse3");
+        return ret;
+#else
+        return false;
+#endif
+    }
+
+#if defined(SERIALIZER_X86_DISPATCH) || defined(__SSSE3__)
+
+    //Reverse bytes of values with 16 byte shuffles, returns amount of values converted
+    template<size_t size>
+    SERIALIZER_TARGET("ssse3")
+    static size_t reorder_copy_ssse3(char *out, const char *in, size_t count)
+    {
+        static constexpr auto mask = reorder_mask<size>();
+        auto shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask.data()));
+        size_t i = 0;
+        for (; i + 16 / size <= count; i += 16 / size)
+        {
+            auto val = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i * size));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i * size), _mm_shuffle_epi8(val, shuffle));
+        }
+        return i;
+    }
+
+#endif
+
+#if defined(SERIALIZER_X86_DISPATCH) || defined(__AVX2__)
+
+    //Reverse bytes of values with 32 byte shuffles, returns amount of values converted
+    template<size_t size>
+    SERIALIZER_TARGET("avx2")
+    static size_t reorder_copy_avx2(char *out, const char *in, size_t count)
+    {
+        static constexpr auto mask = reorder_mask<size>();
+        auto shuffle = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mask.data()));
+        size_t i = 0;
+        for (; i + 32 / size <= count; i += 32 / size)
+        {
+            auto val = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i * size));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i * size), _mm256_shuffle_epi8(val, shuffle));
+        }
+        return i;
+    }
+
+#endif
+
+    //Copy count values of given size from src to dst, converting them between host and serialization byte order
+    template<size_t size>
+    static void reorder_copy(void *dst, const void *src, size_t count)
+    {
+        if constexpr (order == Host || size == 1)
+        {
+            memcpy(dst, src, count * size);
+        }
+        else
+        {
+            auto out = static_cast<char *>(dst);
+            auto in = static_cast<const char *>(src);
+            size_t i = 0;
+            if constexpr (is_swappable_size_v<char[size]>)
+            {
+#if defined(SERIALIZER_X86_DISPATCH) || defined(__AVX2__)
+                if (has_avx2())
+                {
+                    i = reorder_copy_avx2<size>(out, in, count);
+                }
+#endif
+#if defined(SERIALIZER_X86_DISPATCH) || defined(__SSSE3__)
+                if (has_ssse3())
+                {
+                    i += reorder_copy_ssse3<size>(out + i * size, in + i * size, count - i);
+                }
+#endif
+                for (; i < count; ++i)
+                {
+                    uint_of_size_t<size> val;
+                    memcpy(&val, in + i * size, size);
+                    val = reorder<decltype(val), LittleEndian, BigEndian>(val);
+                    memcpy(out + i * size, &val, size);
+                }
+            }
+            else
+            {
+                for (; i < count; ++i)
+                {
+                    for (size_t j = 0; j < size; ++j)
+                    {
+                        out[i * size + j] = in[i * size + size - 1 - j];
+                    }
+                }
+            }
+        }
+    }
+
+    static constexpr ValueType typePriority[] = {DeltaPacked,
+                                                 Optimized,
+                                                 Arithmetic,
+                                                 Enum,
+                                                 ArithmeticArray,
+                                                 PackedContiguous,
+                                                 ArithmeticContiguous,
+                                                 ArithmeticView,
+                                                 Array,
+                                                 Tuple,
+                                                 Iterable,
+                                                 NonSerializable};
+
+    template<class T, ValueType tag, class = void>
+    struct qualifies : public std::false_type
+    {
+    };
+
+    template<class T, ValueType tag>
+    static constexpr bool qualifies_v = qualifies<T, tag>::value;
+
+    template<class T>
+    struct qualifies<T, DeltaPacked, std::enable_if_t<Serialization::is_delta_packed_v<plain_value<T>>>>
+            : public std::true_type
+    {
+        static_assert(std::is_integral_v<typename plain_value<T>::value_type> &&
+                      (sizeof(typename plain_value<T>::value_type) == 4 || sizeof(typename plain_value<T>::value_type) == 8),
+                      "Delta packed container must store 32 or 64 bit integers");
+    };
+
+    template<class T>
+    struct qualifies<T, Optimized,
+            std::enable_if_t<is_std_array_v<T> &&
+                             (qualifies_v<std::remove_pointer_t<decltype(std::data(ldeclval<T>()))>, Arithmetic> ||
+                              qualifies_v<std::remove_pointer_t<decltype(std::data(
+                                      ldeclval<T>()))>, ArithmeticArray> ||
+                              is_bytewise_v<typename T::value_type>)>>
+            : public std::true_type
+    {
+    };
+
+    template<class T>
+    struct qualifies<T, Optimized, std::enable_if_t<is_forward_list_v<T>>> : public std::true_type
+    {
+    };
+
+    template<class T>
+    struct qualifies<T, Arithmetic, std::enable_if_t<std::is_arithmetic_v<plain_value<T>>>> : public std::true_type
+    {
+    };
+
+    template<class T>
+    struct qualifies<T, Enum, std::enable_if_t<std::is_enum_v<plain_value<T>>>> : public std::true_type
+    {
+    };
+
+    template<class T>
+    struct qualifies<T, ArithmeticArray,
+            std::enable_if_t<std::is_array_v<plain_value<T>> &&
+                             std::is_integral_v<decltype(std::rank_v<plain_value<T>>)> &&
+                             (std::rank_v<plain_value<T>> > 0) &&
+                             (std::extent_v<plain_value<T>> > 0) &&
+                             (qualifies_v<std::remove_extent_t<plain_value<T>>, Arithmetic> ||
+                              qualifies_v<std::remove_extent_t<plain_value<T>>, ArithmeticArray> ||
+                              qualifies_v<std::remove_extent_t<plain_value<T>>, Enum> ||
+                              is_bytewise_v<std::remove_extent_t<plain_value<T>>>)>>
+            : public std::true_type
+    {
+    };
+
+    template<class T>
+    struct qualifies<T, ArithmeticContiguous,
+            std::enable_if_t<std::is_convertible_v<decltype(std::data(ldeclval<plain_value<T>>())), void *> &&
+                             std::is_integral_v<decltype(std::size(ldeclval<plain_value<T>>()))> &&
+                             (qualifies_v<std::remove_pointer_t<decltype(std::data(
+                                     ldeclval<plain_value<T>>()))>, Arithmetic> ||
+                              qualifies_v<std::remove_pointer_t<decltype(std::data(
+                                      ldeclval<plain_value<T>>()))>, Enum> ||
+                              is_bytewise_v<std::remove_pointer_t<decltype(std::data(
+                                      ldeclval<plain_value<T>>()))>>) &&
+                             is_resizable_v<plain_value<T>>>>
+            : public std::true_type
+    {
+    };
+
+    template<class T>
+    struct qualifies<T, PackedContiguous,
+            std::enable_if_t<(qualifies_v<T, ArithmeticContiguous> || qualifies_v<T, ArithmeticView>) &&
+                             is_packable_v<std::remove_pointer_t<decltype(std::data(ldeclval<plain_value<T>>()))>>>>
+            : public std::true_type
+    {
+    };
+
+    template<class T>
+    struct qualifies<T, ArithmeticView,
+            std::enable_if_t<is_view_v<plain_value<T>> &&
+                             (qualifies_v<typename plain_value<T>::value_type, Arithmetic> ||
+                              qualifies_v<typename plain_value<T>::value_type, Enum>)>>
+            : public std::true_type
+    {
+    };
+
+    template<class T>
+    struct qualifies<T, Array,
+            std::enable_if_t<std::is_array_v<plain_value<T>> &&
+                             std::is_integral_v<decltype(std::rank_v<plain_value<T>>)> &&
+                             (std::rank_v<plain_value<T>> > 0) &&
+                             (std::extent_v<plain_value<T>> > 0)>>
+            : public std::true_type
+    {
+    };
+
+    template<class T>
+    struct qualifies<T, Tuple, std::enable_if_t<is_tuple_serializable_v<T>>> : public std::true_type
+    {
+    };
+
+    template<class T>
+    struct qualifies<T, Iterable,
+            std::enable_if_t<std::is_base_of_v<std::input_iterator_tag,
+                    typename std::iterator_traits<decltype(std::begin(
+                            ldeclval<plain_value<T>>()))>::iterator_category> &&
+                             std::is_base_of_v<std::input_iterator_tag,
+                                     typename std::iterator_traits<decltype(std::end(
+                                             ldeclval<plain_value<T>>()))>::iterator_category> &&
+                             is_insertable_v<plain_value<T>> && has_size_v<plain_value<T>> &&
+                             !std::is_same_v<std::vector<bool>, T>>>
+            : public std::true_type
+    {
+    };
+
+    template<class T>
+    struct qualifies<T, NonSerializable> : public std::true_type
+    {
+    };
+
+    template<class T, size_t i = 0>
+    static constexpr ValueType priority_type()
+    {
+        if constexpr (i == std::size(typePriority) || qualifies_v<T, typePriority[i]>)
+        {
+            return typePriority[i];
+        }
+        else
+        {
+            return priority_type<T, i + 1>();
+        }
+    }
+
+    //Packed integers
+    //Values are split into blocks of packedBlockSize, each block stores 2 bit length codes of its values followed by
+    //their little endian bytes without leading zero bytes. Lengths of 16 bit values are 1-2, of 32 bit ones 1-4, of
+    //64 bit ones 1, 2, 4, 8
+
+    static constexpr size_t packedBlockSize = 1024;
+
+    template<size_t size>
+    static constexpr size_t packed_length(size_t code)
+    {
+        if constexpr (size == 2)
+        {
+            //Only codes 0 and 1 are written, others are read as them, so lengths never exceed the value size
+            return (code & 1) + 1;
+        }
+        else
+        {
+            return size == 4 ? code + 1 : size_t(1) << code;
+        }
+    }
+
+    template<size_t size>
+    static constexpr size_t packed_code(uint_of_size_t<size> val)
+    {
+        if constexpr (size == 2)
+        {
+            return size_t(val > 0xFF);
+        }
+        else if constexpr (size == 4)
+        {
+            return size_t(val > 0xFF) + size_t(val > 0xFFFF) + size_t(val > 0xFFFFFF);
+        }
+        else
+        {
+            return size_t(val > 0xFF) + size_t(val > 0xFFFF) + size_t(val > 0xFFFFFFFF);
+        }
+    }
+
+    //Total byte length of 4 values described by a control byte
+    template<size_t size>
+    static constexpr std::array<uint8_t, 256> packed_lengths()
+    {
+        std::array<uint8_t, 256> ret {};
+        for (size_t i = 0; i < ret.size(); ++i)
+        {
+            for (size_t j = 0; j < 4; ++j)
+            {
+                ret[i] = uint8_t(ret[i] + packed_length<size>(i >> (j * 2) & 3));
+            }
+        }
+        return ret;
+    }
+
+    //Shuffle masks spreading 4 packed 32 bit values described by a control byte into a 16 byte vector
+    static constexpr std::array<std::array<char, 16>, 256> packed_masks()
+    {
+        std::array<std::array<char, 16>, 256> ret {};
+        for (size_t i = 0; i < ret.size(); ++i)
+        {
+            size_t offset = 0;
+            for (size_t j = 0; j < 4; ++j)
+            {
+                auto length = packed_length<4>(i >> (j * 2) & 3);
+                for (size_t k = 0; k < 4; ++k)
+                {
+                    ret[i][j * 4 + k] = k < length ? char(offset + k) : char(-1);
+                }
+                offset += length;
+            }
+        }
+        return ret;
+    }
+
+    template<class V>
+    static constexpr uint_of_size_t<sizeof(V)> packed_encode(V val)
+    {
+        typedef uint_of_size_t<sizeof(V)> U;
+        if constexpr (std::is_signed_v<V>)
+        {
+            return U(U(val) << 1) ^ U(val >> (sizeof(V) * 8 - 1));
+        }
+        else
+        {
+            return U(val);
+        }
+    }
+
+    template<class V>
+    static constexpr V packed_decode(uint_of_size_t<sizeof(V)> val)
+    {
+        typedef uint_of_size_t<sizeof(V)> U;
+        if constexpr (std::is_signed_v<V>)
+        {
+            return V((val >> 1) ^ U(~(val & 1) + 1));
+        }
+        else
+        {
+            return V(val);
+        }
+    }
+
+    template<class V>
+    static size_t packed_byte_size(const V *src, size_t count)
+    {
+        size_t size = (count + 3) / 4;
+        for (size_t i = 0; i < count; ++i)
+        {
+            size += packed_length<sizeof(V)>(packed_code<sizeof(V)>(packed_encode(src[i])));
+        }
+        return size;
+    }
+
+    //Pack a block of values, returns size of packed data
+    template<class V>
+    static size_t pack_block(char *dst, const V *src, size_t count)
+    {
+        typedef uint_of_size_t<sizeof(V)> U;
+        auto ctrlSize = (count + 3) / 4;
+        memset(dst, 0, ctrlSize);
+        auto data = dst + ctrlSize;
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto val = packed_encode(src[i]);
+            auto code = packed_code<sizeof(V)>(val);
+            dst[i / 4] = char(dst[i / 4] | char(code << (i % 4 * 2)));
+            auto le = reorder<U, Host, LittleEndian>(val);
+            memcpy(data, &le, sizeof(le));
+            data += packed_length<sizeof(V)>(code);
+        }
+        return size_t(data - dst);
+    }
+
+#if defined(SERIALIZER_X86_DISPATCH) || defined(__SSSE3__)
+
+    //Unpack 32 bit values by 4 with shuffles while 16 bytes can be loaded, returns amount of values unpacked
+    template<class V>
+    SERIALIZER_TARGET("ssse3")
+    static size_t unpack_block_ssse3(const uint8_t *ctrl, const char *&data, const char *dataEnd, V *dst, size_t count)
+    {
+        static constexpr auto masks = packed_masks();
+        static constexpr auto lengths = packed_lengths<4>();
+        size_t i = 0;
+        for (; i + 4 <= count && dataEnd - data >= 16; i += 4)
+        {
+            auto c = ctrl[i / 4];
+            auto val = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(masks[c].data())));
+            if constexpr (std::is_signed_v<V>)
+            {
+                val = _mm_xor_si128(_mm_srli_epi32(val, 1),
+                                    _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(val, _mm_set1_epi32(1))));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), val);
+            data += lengths[c];
+        }
+        return i;
+    }
+
+#endif
+
+    //Unpack a block of values, data must contain exactly the bytes described by control bytes
+    template<class V>
+    static void unpack_block(const uint8_t *ctrl, const char *data, [[maybe_unused]] const char *dataEnd, V *dst,
+                             size_t count)
+    {
+        typedef uint_of_size_t<sizeof(V)> U;
+        size_t i = 0;
+#if defined(SERIALIZER_X86_DISPATCH) || defined(__SSSE3__)
+        if constexpr (sizeof(V) == 4 && Host == LittleEndian)
+        {
+            if (has_ssse3())
+            {
+                i = unpack_block_ssse3(ctrl, data, dataEnd, dst, count);
+            }
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            auto length = packed_length<sizeof(V)>(ctrl[i / 4] >> (i % 4 * 2) & 3);
+            U val = 0;
+            if constexpr (Host == LittleEndian)
+            {
+                memcpy(&val, data, length);
+            }
+            else
+            {
+                for (size_t j = 0; j < length; ++j)
+                {
+                    val = U(val | U(uint8_t(data[j])) << (j * 8));
+                }
+            }
+            dst[i] = packed_decode<V>(val);
+            data += length;
+        }
+    }
+
+    //Delta packed integers
+    //Values are replaced by their differences with previous ones modulo 2^bits, so any order round trips, but sorted
+    //values give small deltas. Full blocks of deltaBlockSize deltas are stored as a bit width followed by deltas
+    //bitpacked in 4 interleaved 32 bit lanes, 64 bit deltas wider than 32 bits are stored as is. The rest are varints
+
+    static constexpr size_t deltaBlockSize = 128;
+    static constexpr uint8_t deltaRawWidth = 64;
+
+    template<class T, class Func>
+    static void for_each_delta_block(const T &val, Func &&func)
+    {
+        typedef uint_of_size_t<sizeof(typename T::value_type)> U;
+        U deltas[deltaBlockSize];
+        U prev = 0;
+        size_t count = 0;
+        for (auto &i : val)
+        {
+            auto cur = U(i);
+            deltas[count++] = U(cur - prev);
+            prev = cur;
+            if (count == deltaBlockSize)
+            {
+                func(deltas, count);
+                count = 0;
+            }
+        }
+        if (count > 0)
+        {
+            func(deltas, count);
+        }
+    }
+
+    template<class U>
+    static size_t delta_block_width(const U *deltas)
+    {
+        U bits = 0;
+        for (size_t i = 0; i < deltaBlockSize; ++i)
+        {
+            bits |= deltas[i];
+        }
+        auto width = bit_width(bits);
+        return width > 32 ? deltaRawWidth : width;
+    }
+
+    template<class U>
+    static size_t delta_byte_size(const U *deltas, size_t count)
+    {
+        if (count < deltaBlockSize)
+        {
+            size_t size = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                size += varint_size(deltas[i]);
+            }
+            return size;
+        }
+        auto width = delta_block_width(deltas);
+        return 1 + (width == deltaRawWidth ? deltaBlockSize * sizeof(U) : width * deltaBlockSize / 8);
+    }
+
+    //Pack a full block of deltas, returns size of packed data
+    template<class U>
+    static size_t pack_delta_block(char *dst, const U *deltas)
+    {
+        auto width = delta_block_width(deltas);
+        dst[0] = char(width);
+        if (width == deltaRawWidth)
+        {
+            for (size_t i = 0; i < deltaBlockSize; ++i)
+            {
+                auto le = reorder<U, Host, LittleEndian>(deltas[i]);
+                memcpy(dst + 1 + i * sizeof(U), &le, sizeof(U));
+            }
+            return 1 + deltaBlockSize * sizeof(U);
+        }
+        for (size_t lane = 0; lane < 4 && width > 0; ++lane)
+        {
+            uint32_t word = 0;
+            size_t bit = 0;
+            size_t k = 0;
+            for (size_t j = 0; j < deltaBlockSize / 4; ++j)
+            {
+                auto val = uint32_t(deltas[j * 4 + lane]);
+                word |= val << bit;
+                if (bit + width >= 32)
+                {
+                    auto le = reorder<uint32_t, Host, LittleEndian>(word);
+                    memcpy(dst + 1 + (k++ * 4 + lane) * sizeof(uint32_t), &le, sizeof(uint32_t));
+                    word = bit + width > 32 ? val >> (32 - bit) : 0;
+                    bit = bit + width - 32;
+                }
+                else
+                {
+                    bit += width;
+                }
+            }
+        }
+        return 1 + width * deltaBlockSize / 8;
+    }
+
+    //Unpack a block of deltas bitpacked with given width
+    static void unpack_delta_bits(const char *src, size_t width, uint32_t *dst)
+    {
+        if (width == 0)
+        {
+            memset(dst, 0, deltaBlockSize * sizeof(uint32_t));
+            return;
+        }
+#if defined(__SSE2__)
+        if constexpr (Host == LittleEndian)
+        {
+            auto in = reinterpret_cast<const __m128i *>(src);
+            auto mask = _mm_set1_epi32(int(width == 32 ? ~uint32_t(0) : (uint32_t(1) << width) - 1));
+            auto cur = _mm_loadu_si128(in++);
+            size_t bit = 0;
+            for (size_t j = 0; j < deltaBlockSize / 4; ++j)
+            {
+                auto val = _mm_srl_epi32(cur, _mm_cvtsi32_si128(int(bit)));
+                if (bit + width > 32)
+                {
+                    cur = _mm_loadu_si128(in++);
+                    val = _mm_or_si128(val, _mm_sll_epi32(cur, _mm_cvtsi32_si128(int(32 - bit))));
+                    bit = bit + width - 32;
+                }
+                else if (bit + width == 32)
+                {
+                    if (j + 1 < deltaBlockSize / 4)
+                    {
+                        cur = _mm_loadu_si128(in++);
+                    }
+                    bit = 0;
+                }
+                else
+                {
+                    bit += width;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + j * 4), _mm_and_si128(val, mask));
+            }
+            return;
+        }
+#endif
+        auto mask = width == 32 ? ~uint32_t(0) : (uint32_t(1) << width) - 1;
+        for (size_t lane = 0; lane < 4; ++lane)
+        {
+            size_t bit = 0;
+            size_t k = 0;
+            uint32_t cur;
+            memcpy(&cur, src + (k++ * 4 + lane) * sizeof(uint32_t), sizeof(cur));
+            cur = reorder<uint32_t, LittleEndian, Host>(cur);
+            for (size_t j = 0; j < deltaBlockSize / 4; ++j)
+            {
+                auto val = cur >> bit;
+                if (bit + width >= 32 && (bit + width > 32 || j + 1 < deltaBlockSize / 4))
+                {
+                    memcpy(&cur, src + (k++ * 4 + lane) * sizeof(uint32_t), sizeof(cur));
+                    cur = reorder<uint32_t, LittleEndian, Host>(cur);
+                    if (bit + width > 32)
+                    {
+                        val |= cur << (32 - bit);
+                    }
+                    bit = bit + width - 32;
+                }
+                else
+                {
+                    bit += width;
+                }
+                dst[j * 4 + lane] = val & mask;
+            }
+        }
+    }
+
+    //Take a full block of deltas and restore values from them
+    template<class V, class In>
+    static void take_delta_block(In &in, V *dst, uint_of_size_t<sizeof(V)> &prev)
+    {
+        typedef uint_of_size_t<sizeof(V)> U;
+        uint8_t width;
+        in.take(&width, 1);
+        if (width == deltaRawWidth && sizeof(U) == 8)
+        {
+            for (size_t i = 0; i < deltaBlockSize; ++i)
+            {
+                U delta;
+                in.take(&delta, sizeof(delta));
+                prev = U(prev + reorder<U, LittleEndian, Host>(delta));
+                dst[i] = V(prev);
+            }
+            return;
+        }
+        if (width > 32)
+        {
+            throw Serialization::DeserializationError("Malformed delta packed block");
+        }
+        char buf[deltaBlockSize * sizeof(uint32_t)];
+        auto src = in.borrow(width * deltaBlockSize / 8);
+        if (!src)
+        {
+            in.take(buf, width * deltaBlockSize / 8);
+            src = buf;
+        }
+        uint32_t deltas[deltaBlockSize];
+        unpack_delta_bits(src, width, deltas);
+        size_t i = 0;
+#if defined(__SSE2__)
+        if constexpr (sizeof(V) == 4)
+        {
+            auto sum = _mm_set1_epi32(int(prev));
+            for (; i < deltaBlockSize; i += 4)
+            {
+                auto val = _mm_loadu_si128(reinterpret_cast<const __m128i *>(deltas + i));
+                val = _mm_add_epi32(val, _mm_slli_si128(val, 4));
+                val = _mm_add_epi32(val, _mm_slli_si128(val, 8));
+                sum = _mm_add_epi32(val, sum);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), sum);
+                sum = _mm_shuffle_epi32(sum, 0xFF);
+            }
+            prev = U(dst[deltaBlockSize - 1]);
+        }
+#endif
+        for (; i < deltaBlockSize; ++i)
+        {
+            prev = U(prev + deltas[i]);
+            dst[i] = V(prev);
+        }
+    }
+
+    //Calculate size
+
+    template<class T, class = void>
+    struct byte_size
+    {
+        static_assert(priority_type<T>() != NonSerializable, "Value must be serializable");
+    };
+
+    template<class T>
+    static constexpr size_t byte_size_f(const T &val)
+    {
+        if constexpr (is_fixed_size_v<T>)
+        {
+            return fixed_byte_size_v<T>;
+        }
+        else
+        {
+            return byte_size<T>::get(val);
+        }
+    }
+
+    template<class T>
+    struct byte_size<T, std::enable_if_t<priority_type<T>() == DeltaPacked>>
+    {
+        static size_t get(const T &val)
+        {
+            auto size = size_byte_size<typename T::size_type>(std::size(val));
+            for_each_delta_block(val, [&size](const auto *deltas, size_t count)
+            {
+                size += delta_byte_size(deltas, count);
+            });
+            return size;
+        }
+    };
+
+    template<class T>
+    struct byte_size<T, std::enable_if_t<priority_type<T>() == Optimized && is_std_array_v<T>>>
+    {
+        static constexpr size_t get(const T &val)
+        {
+            return val.size() * sizeof(typename T::value_type);
+        }
+    };
+
+    template<class T>
+    struct byte_size<T, std::enable_if_t<priority_type<T>() == Optimized && is_forward_list_v<T>>>
+    {
+        static constexpr size_t get(const T &val)
+        {
+            size_t size = 0;
+            size_t count = 0;
+            for (auto &i : val)
+            {
+                size += byte_size_f<decltype(i)>(i);
+                ++count;
+            }
+            return size_byte_size<typename T::size_type>(count) + size;
+        }
+    };
+
+    template<class T>
+    struct byte_size<T, std::enable_if_t<priority_type<T>() == Arithmetic>>
+    {
+        static constexpr size_t get(const T &val)
+        {
+            if constexpr (is_varint_v<T>)
+            {
+                return varint_size(to_varint(val));
+            }
+            else
+            {
+                return sizeof(T);
+            }
+        }
+    };
+
+    template<class T>
+    struct byte_size<T, std::enable_if_t<priority_type<T>() == Enum>>
+    {
+        static constexpr size_t get(const T &val)
+        {
+            return byte_size_f(static_cast<std::underlying_type_t<plain_value<T>>>(val));
+        }
+    };
+
+    template<class T>
+    struct byte_size<T, std::enable_if_t<priority_type<T>() == ArithmeticArray>>
+    {
+        static constexpr size_t get(const T &)
+        {
+            return sizeof(T);
+        }
+    };
+
+    template<class T>
+    struct byte_size<T, std::enable_if_t<priority_type<T>() == ArithmeticContiguous ||
+                                  priority_type<T>() == ArithmeticView>>
+    {
+        static constexpr size_t get(const T &val)
+        {
+            return size_byte_size<decltype(std::size(val))>(std::size(val)) +
+                   std::size(val) * sizeof(std::remove_pointer_t<decltype(std::data(val))>);
+        }
+    };
+
+    template<class T>
+    struct byte_size<T, std::enable_if_t<priority_type<T>() == PackedContiguous>>
+    {
+        static constexpr size_t get(const T &val)
+        {
+            return size_byte_size<decltype(std::size(val))>(std::size(val)) +
+                   packed_byte_size(std::data(val), std::size(val));
+        }
+    };
+
+    template<class T>
+    struct byte_size<T, std::enable_if_t<priority_type<T>() == Array>>
+    {
+        static constexpr size_t get(const T &val)
+        {
+            size_t size = 0;
+            for (auto &i : val)
+            {
+                size += byte_size_f(i);
+            }
+            return size;
+        }
+    };
+
+    template<class T, size_t i = 0>
+    static constexpr size_t tuple_byte_size(const T &val)
+    {
+        if constexpr (i + 1 == tuple_size_v<T>)
+        {
+            return byte_size_f(tuple_get_f<T, i>(val));
+        }
+        else
+        {
+            return byte_size_f(tuple_get_f<T, i>(val)) + tuple_byte_size<T, i + 1>(val);
+        }
+    }
+
+    template<class T>
+    struct byte_size<T, std::enable_if_t<priority_type<T>() == Tuple>>
+    {
+        static constexpr size_t get(const T &val)
+        {
+            return tuple_byte_size(val);
+        }
+    };
+
+    template<class T>
+    struct byte_size<T, std::enable_if_t<priority_type<T>() == Iterable>>
+    {
+        static constexpr size_t get(const T &val)
+        {
+            size_t size = size_byte_size<decltype(std::size(val))>(std::size(val));
+            if constexpr (is_fixed_size_v<typename T::value_type>)
+            {
+                return size + std::size(val) * fixed_byte_size_v<typename T::value_type>;
+            }
+            for (auto &i : val)
+            {
+                size += byte_size_f(i);
+            }
+            return size;
+        }
+    };
+
+    //Calculate size via sizeof
+
+    template<class T, class = void>
+    struct byte_minsize
+    {
+        static_assert(priority_type<T>() != NonSerializable, "Value must be serializable");
+    };
+
+    template<class T>
+    static constexpr size_t byte_minsize_v = byte_minsize<T>::value;
+
+    template<class T>
+    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == DeltaPacked>>
+    {
+        static constexpr size_t value = size_byte_minsize_v<typename T::size_type>;
+    };
+
+    template<class T>
+    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Optimized && is_std_array_v<T>>>
+    {
+        static constexpr size_t value = sizeof(typename T::value_type) * std::tuple_size_v<T>;
+    };
+
+    template<class T>
+    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Optimized && is_forward_list_v<T>>>
+    {
+        static constexpr size_t value = size_byte_minsize_v<typename T::size_type>;
+    };
+
+    template<class T>
+    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Arithmetic>>
+    {
+        static constexpr size_t value = is_varint_v<T> ? 1 : sizeof(T);
+    };
+
+    template<class T>
+    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Enum>>
+    {
+        static constexpr size_t value = byte_minsize_v<std::underlying_type_t<plain_value<T>>>;
+    };
+
+    template<class T>
+    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == ArithmeticArray>>
+    {
+        static constexpr size_t value = sizeof(T);
+    };
+
+    template<class T>
+    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == ArithmeticContiguous ||
+                                  priority_type<T>() == ArithmeticView>>
+    {
+        static constexpr size_t value = size_byte_minsize_v<decltype(std::size(std::declval<T>()))>;
+    };
+
+    template<class T>
+    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == PackedContiguous>>
+    {
+        static constexpr size_t value = size_byte_minsize_v<decltype(std::size(std::declval<T>()))>;
+    };
+
+    template<class T>
+    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Array>>
+    {
+        static constexpr size_t value = std::extent_v<T> * byte_minsize_v<std::remove_extent_t<T>>;
+    };
+
+    template<class T, size_t i = 0>
+    static constexpr size_t tuple_byte_minsize()
+    {
+        if constexpr (i + 1 == tuple_size_v<T>)
+        {
+            return byte_minsize_v<tuple_element_t<T, tuple_size_v<T> - 1>>;
+        }
+        else
+        {
+            return byte_minsize_v<tuple_element_t<T, i>> + tuple_byte_minsize<T, i + 1>();
+        }
+    }
+
+    template<class T>
+    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Tuple>>
+    {
+        static constexpr size_t value =  tuple_byte_minsize<T>();
+    };
+
+    template<class T>
+    struct byte_minsize<T, std::enable_if_t<priority_type<T>() == Iterable>>
+    {
+        static constexpr size_t value = size_byte_minsize_v<decltype(std::size(std::declval<T>()))>;
+    };
+
+    //Types of fixed serialized size, which is equal to their minimal size
+
+    template<class T, class = void>
+    struct is_fixed_size : std::false_type
+    {
+    };
+
+    template<class T>
+    static constexpr bool is_fixed_size_v = is_fixed_size<plain_value<T>>::value;
+
+    //Serialized size of a value known at compile time, 0 if it depends on the value
+    template<class T>
+    static constexpr size_t fixed_byte_size_v = is_fixed_size_v<T> ? byte_minsize_v<plain_value<T>> : 0;
+
+    template<class T, size_t ... i>
+    static constexpr bool tuple_fixed_size(std::index_sequence<i...>)
+    {
+        return (is_fixed_size_v<tuple_element_t<T, i>> && ...);
+    }
+
+    template<class T>
+    struct is_fixed_size<T, std::enable_if_t<priority_type<T>() == Arithmetic>> : std::bool_constant<!is_varint_v<T>>
+    {
+    };
+
+    template<class T>
+    struct is_fixed_size<T, std::enable_if_t<priority_type<T>() == Enum>> : is_fixed_size<std::underlying_type_t<T>>
+    {
+    };
+
+    template<class T>
+    struct is_fixed_size<T, std::enable_if_t<priority_type<T>() == ArithmeticArray ||
+                                             (priority_type<T>() == Optimized && is_std_array_v<T>)>> : std::true_type
+    {
+    };
+
+    template<class T>
+    struct is_fixed_size<T, std::enable_if_t<priority_type<T>() == Array>> : is_fixed_size<std::remove_extent_t<T>>
+    {
+    };
+
+    template<class T>
+    struct is_fixed_size<T, std::enable_if_t<priority_type<T>() == Tuple>>
+        : std::bool_constant<tuple_fixed_size<T>(std::make_index_sequence<tuple_size_v<T>>())>
+    {
+    };
+
+    //Output
+
+    //Outputs which check their capacity on every put, so fixed size values are better passed to them at once
+    template<class Out>
+    struct is_container_output : std::false_type
+    {
+    };
+
+    template<class Container>
+    struct is_container_output<Serialization::ContainerOutput<Container>> : std::true_type
+    {
+    };
+
+    static void put(char *&ptr, const void *src, size_t size)
+    {
+        memcpy(ptr, src, size);
+        ptr += size;
+    }
+
+    template<class Out>
+    static void put(Out &out, const void *src, size_t size)
+    {
+        out.put(src, size);
+    }
+
+    //Put count arithmetic values of type V, converting them to serialization byte order
+    template<class V>
+    static void put_values(char *&ptr, const void *src, size_t count)
+    {
+        reorder_copy<sizeof(V)>(ptr, src, count);
+        ptr += count * sizeof(V);
+    }
+
+    //Outputs which can reference data of serialized values in place instead of copying it
+    template<class Out, class = void>
+    struct is_referencing_output : std::false_type
+    {
+    };
+
+    template<class Out>
+    struct is_referencing_output<Out, std::void_t<decltype(std::declval<Out &>().reference(nullptr, size_t()))>>
+            : std::true_type
+    {
+    };
+
+    //Put data of a serialized value, which outlives the output
+    template<class Out>
+    static void put_persistent(Out &out, const void *src, size_t size)
+    {
+        if constexpr (is_referencing_output<Out>::value)
+        {
+            out.reference(src, size);
+        }
+        else
+        {
+            put(out, src, size);
+        }
+    }
+
+    template<class V, class Out>
+    static void put_values(Out &out, const void *src, size_t count)
+    {
+        if constexpr (order == Host || sizeof(V) == 1)
+        {
+            put_persistent(out, src, count * sizeof(V));
+        }
+        else
+        {
+            constexpr size_t chunkCount = 4096 / sizeof(V);
+            char buf[chunkCount * sizeof(V)];
+            auto in = static_cast<const char *>(src);
+            while (count > 0)
+            {
+                auto current = count < chunkCount ? count : chunkCount;
+                reorder_copy<sizeof(V)>(buf, in, current);
+                put(out, buf, current * sizeof(V));
+                in += current * sizeof(V);
+                count -= current;
+            }
+        }
+    }
+
+    template<class Out>
+    static void put_varint(Out &out, uint64_t val)
+    {
+        char buf[maxVarintSize];
+        size_t size = 0;
+        for (; val >= 0x80; val >>= 7)
+        {
+            buf[size++] = char(val | 0x80);
+        }
+        buf[size++] = char(val);
+        put(out, buf, size);
+    }
+
+    //Append
+
+    template<class T, class = void>
+    struct append
+    {
+        static_assert(priority_type<T>() != NonSerializable, "Value must be serializable");
+    };
+
+    template<class T, class Out>
+    static constexpr void append_f(Out &out, const T &val)
+    {
+        return append<T>::get(out, val);
+    }
+
+    //Append container size prefix
+    template<class T, class Out>
+    static void append_size(Out &out, size_t size)
+    {
+        if constexpr (encoding == FixedWidth)
+        {
+            append_f(out, static_cast<size_type_t<T>>(size));
+        }
+        else
+        {
+            put_varint(out, size);
+        }
+    }
+
+    template<class T>
+    struct append<T, std::enable_if_t<priority_type<T>() == DeltaPacked>>
+    {
+        template<class Out>
+        static void get(Out &out, const T &val)
+        {
+            append_size<typename T::size_type>(out, std::size(val));
+            for_each_delta_block(val, [&out](const auto *deltas, size_t count)
+            {
+                if (count < deltaBlockSize)
+                {
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        put_varint(out, deltas[i]);
+                    }
+                }
+                else
+                {
+                    char buf[1 + deltaBlockSize * sizeof(*deltas)];
+                    put(out, buf, pack_delta_block(buf, deltas));
+                }
+            });
+        }
+    };
+
+    template<class T>
+    struct append<T, std::enable_if_t<priority_type<T>() == Optimized && is_std_array_v<T>>>
+    {
+        template<class Out>
+        static constexpr void get(Out &out, const T &val)
+        {
+            auto size = byte_size_f(val);
+            put_values<std::remove_all_extents_t<typename T::value_type>>(
+                    out, std::data(val), size / sizeof(std::remove_all_extents_t<typename T::value_type>));
+        }
+    };
+
+    template<class T>
+    struct append<T, std::enable_if_t<priority_type<T>() == Optimized && is_forward_list_v<T>>>
+    {
+        template<class Out>
+        static constexpr void get(Out &out, const T &val)
+        {
+            append_size<typename T::size_type>(out, size_t(std::distance(val.begin(), val.end())));
+            for (auto &i : val)
+            {
+                append_f(out, i);
+            }
+        }
+    };
+
+    template<class T>
+    struct append<T, std::enable_if_t<priority_type<T>() == Arithmetic>>
+    {
+        template<class Out>
+        static constexpr void get(Out &out, const T &val)
+        {
+            if constexpr (is_varint_v<T>)
+            {
+                put_varint(out, to_varint(val));
+            }
+            else
+            {
+                auto ordval = reorder<decltype(val), Host, order>(val);
+                put(out, &ordval, sizeof(ordval));
+            }
+        }
+    };
+
+    template<class T>
+    struct append<T, std::enable_if_t<priority_type<T>() == Enum>>
+    {
+        template<class Out>
+        static constexpr void get(Out &out, const T &val)
+        {
+            append_f(out, *reinterpret_cast<const std::underlying_type_t<plain_value<T>> *>(&val));
+        }
+    };
+
+    template<class T>
+    struct append<T, std::enable_if_t<priority_type<T>() == ArithmeticArray>>
+    {
+        template<class Out>
+        static constexpr void get(Out &out, const T &val)
+        {
+            auto size = byte_size_f(val);
+            put_values<std::remove_all_extents_t<T>>(out, val, size / sizeof(std::remove_all_extents_t<T>));
+        }
+    };
+
+    template<class T>
+    struct append<T, std::enable_if_t<priority_type<T>() == ArithmeticContiguous ||
+                                  priority_type<T>() == ArithmeticView>>
+    {
+        template<class Out>
+        static constexpr void get(Out &out, const T &val)
+        {
+            append_size<decltype(std::size(val))>(out, std::size(val));
+            put_values<std::remove_pointer_t<decltype(std::data(val))>>(out, std::data(val), std::size(val));
+        }
+    };
+
+    template<class T>
+    struct append<T, std::enable_if_t<priority_type<T>() == PackedContiguous>>
+    {
+        template<class Out>
+        static void get(Out &out, const T &val)
+        {
+            typedef std::remove_cv_t<std::remove_pointer_t<decltype(std::data(val))>> value_type;
+            append_size<decltype(std::size(val))>(out, std::size(val));
+            char buf[(packedBlockSize + 3) / 4 + packedBlockSize * sizeof(value_type)];
+            for (size_t done = 0; done < std::size(val); done += packedBlockSize)
+            {
+                auto count = std::size(val) - done < packedBlockSize ? std::size(val) - done : packedBlockSize;
+                put(out, buf, pack_block(buf, std::data(val) + done, count));
+            }
+        }
+    };
+
+    template<class T>
+    struct append<T, std::enable_if_t<priority_type<T>() == Array>>
+    {
+        template<class Out>
+        static constexpr void get(Out &out, const T &val)
+        {
+            for (auto &i : val)
+            {
+                append_f(out, i);
+            }
+        }
+    };
+
+    template<class T, size_t i = 0, class Out>
+    static void append_tuple(Out &out, const T &val)
+    {
+        append_f(out, tuple_get_f<T, i>(val));
+        if constexpr (i + 1 < tuple_size_v<T>)
+        {
+            append_tuple<T, i + 1>(out, val);
+        }
+    }
+
+    template<class T>
+    struct append<T, std::enable_if_t<priority_type<T>() == Tuple>>
+    {
+        template<class Out>
+        static constexpr void get(Out &out, const T &val)
+        {
+            if constexpr (is_bytewise_v<T>)
+            {
+                put(out, &val, sizeof(val));
+            }
+            else if constexpr (fixed_byte_size_v<T> > 0 && is_container_output<Out>::value)
+            {
+                //Write fields to a local buffer and pass it to the output at once
+                char buffer[fixed_byte_size_v<T>];
+                auto ptr = buffer;
+                append_tuple(ptr, val);
+                put(out, buffer, sizeof(buffer));
+            }
+            else
+            {
+                append_tuple(out, val);
+            }
+        }
+    };
+
+    template<class T>
+    struct append<T, std::enable_if_t<priority_type<T>() == Iterable>>
+    {
+        template<class Out>
+        static constexpr void get(Out &out, const T &val)
+        {
+            append_size<decltype(std::size(val))>(out, std::size(val));
+            for (auto i = std::begin(val); i != std::end(val); ++i)
+            {
+                append_f(out, *i);
+            }
+        }
+    };
+
+    // Take
+
+    template<class In>
+    static void check_size(In &in, size_t count, size_t elementSize)
+    {
+        if (elementSize > 0 && count > in.available() / elementSize)
+        {
+            throw Serialization::DeserializationError("Provided serialized data size is too small");
+        }
+    }
+
+    //Take count values of given size into dst, converting them to host byte order
+    template<size_t size, class In>
+    static void take_values(In &in, void *dst, size_t count)
+    {
+        if (auto ptr = in.borrow(count * size))
+        {
+            reorder_copy<size>(dst, ptr, count);
+        }
+        else
+        {
+            in.take(dst, count * size);
+            if constexpr (order != Host && size > 1)
+            {
+                reorder_copy<size>(dst, dst, count);
+            }
+        }
+    }
+
+    //Take contiguous values from an input which doesn't keep data in memory, growing container gradually
+    template<class T, class In>
+    static void take_contiguous_chunked(In &in, T &val, size_t length)
+    {
+        typedef std::remove_cv_t<std::remove_pointer_t<decltype(std::data(val))>> value_type;
+        constexpr size_t chunkCount = Serialization::streamBufferSize / sizeof(value_type);
+        size_t done = 0;
+        do
+        {
+            auto next = done + (length - done < chunkCount ? length - done : chunkCount);
+            val.resize(next);
+            take_values<sizeof(value_type)>(in, std::data(val) + done, next - done);
+            done = next;
+        } while (done < length);
+    }
+
+    template<class T, class = void>
+    struct take
+    {
+        static_assert(priority_type<T>() != NonSerializable, "Value must be serializable");
+    };
+
+    template<class T, class In>
+    static plain_value<T> take_f(In &in)
+    {
+        static_assert(!take<T>::useReference, "This value can only be assigned by reference");
+        return take<T>::get(in);
+    }
+
+    template<class T, class In>
+    static void take_f(In &in, plain_value<T> &val)
+    {
+        static_assert(take<T>::useReference, "This value can not be assigned by reference");
+        take<T>::get(in, val);
+    }
+
+    template<class T, class In>
+    static void take_into(In &in, T &val)
+    {
+        if constexpr (take<plain_value<T>>::useReference)
+        {
+            take_f<T>(in, val);
+        }
+        else
+        {
+            val = take_f<T>(in);
+        }
+    }
+
+    template<class T, class In>
+    static plain_value<T> take_value(In &in)
+    {
+        if constexpr (take<plain_value<T>>::useReference)
+        {
+            plain_value<T> val;
+            take_f<T>(in, val);
+            return val;
+        }
+        else
+        {
+            return take_f<T>(in);
+        }
+    }
+
+    //Construct an empty value with given allocator, following uses-allocator construction conventions
+    template<class T, class Allocator>
+    static T make_with_allocator(const Allocator &alloc)
+    {
+        if constexpr (std::is_constructible_v<T, std::allocator_arg_t, const Allocator &>)
+        {
+            return T(std::allocator_arg, alloc);
+        }
+        else
+        {
+            return T(alloc);
+        }
+    }
+
+    //Take a new element of a container, constructing it with the container's allocator if it needs one
+    template<class V, class T, class In>
+    static V take_element(In &in, const T &container)
+    {
+        if constexpr (uses_container_allocator_v<V, T>)
+        {
+            auto val = make_with_allocator<V>(container.get_allocator());
+            take_into(in, val);
+            return val;
+        }
+        else
+        {
+            return take_value<V>(in);
+        }
+    }
+
+    //Take an element of a container and insert it at the end
+    template<class T, class In>
+    static void take_insert(In &in, T &val)
+    {
+        if constexpr (is_map_v<T>)
+        {
+            //Decode key and mapped value separately and move them into the node, key of a pair can't be moved
+            auto key = take_element<typename T::key_type>(in, val);
+            auto mapped = take_element<typename T::mapped_type>(in, val);
+            val.emplace_hint(val.end(), std::move(key), std::move(mapped));
+        }
+        else
+        {
+            val.insert(val.end(), take_element<typename T::value_type>(in, val));
+        }
+    }
+
+    template<class In>
+    static uint64_t take_varint(In &in)
+    {
+        uint64_t val = 0;
+        auto ptr = in.peek(maxVarintSize);
+        for (size_t i = 0; i < maxVarintSize; ++i)
+        {
+            uint8_t byte;
+            if (ptr)
+            {
+                byte = uint8_t(ptr[i]);
+            }
+            else
+            {
+                in.take(&byte, 1);
+            }
+            val |= uint64_t(byte & 0x7F) << (7 * i);
+            if (byte < 0x80)
+            {
+                if (i + 1 == maxVarintSize && byte > 1)
+                {
+                    break;
+                }
+                if (ptr)
+                {
+                    in.skip(i + 1);
+                }
+                return val;
+            }
+        }
+        throw Serialization::DeserializationError("Malformed variable length integer");
+    }
+
+    //Take container size prefix
+    template<class T, class In>
+    static size_type_t<T> take_size(In &in)
+    {
+        if constexpr (encoding == FixedWidth)
+        {
+            return take_value<size_type_t<T>>(in);
+        }
+        else
+        {
+            return from_varint<size_type_t<T>>(take_varint(in));
+        }
+    }
+
+    template<class T>
+    struct take<T, std::enable_if_t<priority_type<T>() == DeltaPacked>>
+    {
+        static constexpr bool useReference = true;
+
+        template<class In>
+        static void get(In &in, plain_value<T> &val)
+        {
+            typedef typename plain_value<T>::value_type value_type;
+            constexpr bool contiguous = qualifies_v<T, ArithmeticContiguous>;
+            auto length = take_size<typename plain_value<T>::size_type>(in);
+            check_size(in, length / deltaBlockSize + length % deltaBlockSize, 1);
+            auto known = in.available() != std::numeric_limits<size_t>::max();
+            if constexpr (contiguous)
+            {
+                if (known)
+                {
+                    val.resize(length);
+                }
+            }
+            else
+            {
+                reserve_for(in, val, length);
+            }
+            uint_of_size_t<sizeof(value_type)> prev = 0;
+            value_type buf[deltaBlockSize];
+            for (size_t done = 0; done < length; done += deltaBlockSize)
+            {
+                auto count = length - done < deltaBlockSize ? length - done : deltaBlockSize;
+                auto dst = buf;
+                if constexpr (contiguous)
+                {
+                    if (!known)
+                    {
+                        val.resize(done + count);
+                    }
+                    dst = std::data(val) + done;
+                }
+                if (count == deltaBlockSize)
+                {
+                    take_delta_block(in, dst, prev);
+                }
+                else
+                {
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        prev = decltype(prev)(prev + from_varint<decltype(prev)>(take_varint(in)));
+                        dst[i] = value_type(prev);
+                    }
+                }
+                if constexpr (!contiguous)
+                {
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        val.insert(val.end(), buf[i]);
+                    }
+                }
+            }
+        }
+    };
+
+    template<class T>
+    struct take<T, std::enable_if_t<priority_type<T>() == Optimized && is_std_array_v<T>>>
+    {
+        static constexpr bool useReference = true;
+
+        template<class In>
+        static constexpr void get(In &in, plain_value<T> &val)
+        {
+            take_values<sizeof(std::remove_all_extents_t<typename T::value_type>)>(
+                    in, std::data(val), byte_size_f(val) / sizeof(std::remove_all_extents_t<typename T::value_type>));
+        }
+    };
+
+    template<class T>
+    struct take<T, std::enable_if_t<priority_type<T>() == Optimized && is_forward_list_v<T>>>
+    {
+        static constexpr bool useReference = true;
+
+        template<class In>
+        static constexpr void get(In &in, plain_value<T> &val)
+        {
+            auto size = take_size<typename plain_value<T>::size_type>(in);
+            check_size(in, size, byte_minsize_v<typename plain_value<T>::value_type>);
+            auto it = val.before_begin();
+            for (size_t i = 0; i < size; ++i)
+            {
+                if constexpr (take<typename plain_value<T>::value_type>::useReference)
+                {
+                    typename plain_value<T>::value_type el;
+                    take_f<typename plain_value<T>::value_type>(in, el);
+                    it = val.insert_after(it, std::move(el));
+                }
+                else
+                {
+                    it = val.insert_after(it, take_f<typename plain_value<T>::value_type>(in));
+                }
+            }
+        }
+    };
+
+    template<class T>
+    struct take<T, std::enable_if_t<priority_type<T>() == Arithmetic>>
+    {
+        static constexpr bool useReference = true;
+
+        template<class In>
+        static constexpr void get(In &in, plain_value<T> &val)
+        {
+            if constexpr (is_varint_v<T>)
+            {
+                val = from_varint<plain_value<T>>(take_varint(in));
+            }
+            else
+            {
+                plain_value<decltype(val)> nval;
+                in.take(&nval, sizeof(nval));
+                val = reorder<decltype(nval), order, Host>(nval);
+            }
+        }
+    };
+
+    template<class T>
+    struct take<T, std::enable_if_t<priority_type<T>() == Enum>>
+    {
+        static constexpr bool useReference = true;
+
+        template<class In>
+        static constexpr void get(In &in, plain_value<T> &val)
+        {
+            take_f<std::underlying_type_t<plain_value<T>>>(in, *reinterpret_cast<std::underlying_type_t<plain_value<T>> *>(&val));
+        }
+    };
+
+    template<class T>
+    struct take<T, std::enable_if_t<priority_type<T>() == ArithmeticArray>>
+    {
+        static constexpr bool useReference = true;
+
+        template<class In>
+        static constexpr void get(In &in, plain_value<T> &val)
+        {
+            take_values<sizeof(std::remove_all_extents_t<T>)>(in, std::data(val),
+                                                              byte_size_f(val) / sizeof(std::remove_all_extents_t<T>));
+        }
+    };
+
+    template<class T>
+    struct take<T, std::enable_if_t<priority_type<T>() == ArithmeticContiguous>>
+    {
+        static constexpr bool useReference = true;
+
+        template<class In>
+        static constexpr void get(In &in, plain_value<T> &val)
+        {
+            auto length = take_size<decltype(std::size(val))>(in);
+            typedef std::remove_cv_t<std::remove_pointer_t<decltype(std::data(val))>> value_type;
+            check_size(in, length, sizeof(value_type));
+            auto ptr = in.borrow(length * sizeof(value_type));
+            if (!ptr)
+            {
+                take_contiguous_chunked(in, val, length);
+                return;
+            }
+            auto end = ptr + length * sizeof(value_type);
+            if constexpr (is_range_assignable_v<plain_value<T>> &&
+                          !Serialization::is_default_init_allocated_v<plain_value<T>>)
+            {
+                //Insert values copied to a small buffer chunk by chunk, resize() would value-initialize elements
+                //overwritten right after, and serialized data can't be read as values in place
+                constexpr size_t chunkCount = 4096 / sizeof(value_type) > 0 ? 4096 / sizeof(value_type) : 1;
+                value_type chunk[chunkCount];
+                if (length <= chunkCount)
+                {
+                    reorder_copy<sizeof(value_type)>(chunk, ptr, length);
+                    val.assign(chunk, chunk + length);
+                    return;
+                }
+                val.clear();
+                if constexpr (is_reservable_v<plain_value<T>>)
+                {
+                    val.reserve(length);
+                }
+                for (auto cur = ptr; cur != end;)
+                {
+                    auto count = std::min<size_t>(chunkCount, size_t(end - cur) / sizeof(value_type));
+                    reorder_copy<sizeof(value_type)>(chunk, cur, count);
+                    val.insert(val.end(), chunk, chunk + count);
+                    cur += count * sizeof(value_type);
+                }
+            }
+            else
+            {
+                val.resize(length);
+                reorder_copy<sizeof(value_type)>(std::data(val), ptr, std::size(val));
+            }
+        }
+    };
+
+    //Take packed values into contiguous container, input of unknown size grows it block by block
+    template<class T, class In>
+    static void take_packed(In &in, T &val, size_t length)
+    {
+        typedef std::remove_cv_t<std::remove_pointer_t<decltype(std::data(val))>> value_type;
+        static constexpr auto lengths = packed_lengths<sizeof(value_type)>();
+        auto known = in.available() != std::numeric_limits<size_t>::max();
+        if (known)
+        {
+            val.resize(length);
+        }
+        uint8_t ctrlBuf[(packedBlockSize + 3) / 4];
+        char dataBuf[packedBlockSize * sizeof(value_type)];
+        for (size_t done = 0; done < length; done += packedBlockSize)
+        {
+            auto count = length - done < packedBlockSize ? length - done : packedBlockSize;
+            auto ctrlSize = (count + 3) / 4;
+            auto ctrl = reinterpret_cast<const uint8_t *>(in.borrow(ctrlSize));
+            if (!ctrl)
+            {
+                in.take(ctrlBuf, ctrlSize);
+                ctrl = ctrlBuf;
+            }
+            size_t dataSize = 0;
+            for (size_t i = 0; i + 1 < ctrlSize; ++i)
+            {
+                dataSize += lengths[ctrl[i]];
+            }
+            for (size_t i = (ctrlSize - 1) * 4; i < count; ++i)
+            {
+                dataSize += packed_length<sizeof(value_type)>(ctrl[ctrlSize - 1] >> (i % 4 * 2) & 3);
+            }
+            auto data = in.borrow(dataSize);
+            if (!data)
+            {
+                in.take(dataBuf, dataSize);
+                data = dataBuf;
+            }
+            if (!known)
+            {
+                val.resize(done + count);
+            }
+            unpack_block(ctrl, data, data + dataSize, std::data(val) + done, count);
+        }
+    }
+
+    template<class T>
+    struct take<T, std::enable_if_t<priority_type<T>() == PackedContiguous>>
+    {
+        static constexpr bool useReference = true;
+
+        template<class In>
+        static void get(In &in, plain_value<T> &val)
+        {
+            typedef std::remove_cv_t<std::remove_pointer_t<decltype(std::data(val))>> value_type;
+            auto length = take_size<decltype(std::size(val))>(in);
+            check_size(in, length, 1);
+            if constexpr (is_view_v<plain_value<T>>)
+            {
+                static_assert(std::is_same_v<plain_value<T>, Serialization::ArrayView<value_type>>,
+                              "Packed values can't be viewed, use Serialization::ArrayView");
+                std::vector<value_type> storage;
+                take_packed(in, storage, length);
+                val = plain_value<T>(std::move(storage));
+            }
+            else
+            {
+                take_packed(in, val, length);
+            }
+        }
+    };
+
+    template<class T>
+    struct take<T, std::enable_if_t<priority_type<T>() == ArithmeticView>>
+    {
+        static constexpr bool useReference = true;
+
+        template<class In>
+        static constexpr void get(In &in, plain_value<T> &val)
+        {
+            typedef typename plain_value<T>::value_type value_type;
+            auto length = take_size<decltype(std::size(val))>(in);
+            check_size(in, length, sizeof(value_type));
+            auto ptr = in.borrow(length * sizeof(value_type));
+            bool viewable = ptr && (order == Host || sizeof(value_type) == 1) &&
+                            reinterpret_cast<uintptr_t>(ptr) % alignof(value_type) == 0;
+            if (viewable)
+            {
+                val = plain_value<T>(reinterpret_cast<const value_type *>(ptr), length);
+            }
+            else if constexpr (std::is_same_v<plain_value<T>, Serialization::ArrayView<value_type>>)
+            {
+                std::vector<value_type> storage;
+                if (ptr)
+                {
+                    storage.resize(length);
+                    reorder_copy<sizeof(value_type)>(storage.data(), ptr, length);
+                }
+                else
+                {
+                    take_contiguous_chunked(in, storage, length);
+                }
+                val = plain_value<T>(std::move(storage));
+            }
+            else
+            {
+                throw Serialization::DeserializationError(
+                        "Serialized data is not aligned, has wrong byte order or is not kept in memory for a view, "
+                        "use Serialization::ArrayView");
+            }
+        }
+    };
+
+    template<class T>
+    struct take<T, std::enable_if_t<priority_type<T>() == Array>>
+    {
+        static constexpr bool useReference = true;
+
+        template<class In>
+        static constexpr void get(In &in, plain_value<T> &val)
+        {
+            for (auto &i : val)
+            {
+                take_into(in, i);
+            }
+        }
+    };
+
+
+    //Take data of a fixed size value with a single bounds check, so bounds checks of it's fields are resolved at
+    //compile time, data which can't be borrowed is copied to provided buffer of fixed_byte_size_v<T> bytes
+    template<class T, class In>
+    static Serialization::MemoryInput take_fixed_input(In &in, char *buffer)
+    {
+        constexpr auto size = fixed_byte_size_v<T>;
+        auto ptr = in.borrow(size);
+        if (!ptr)
+        {
+            in.take(buffer, size);
+            ptr = buffer;
+        }
+        return {ptr, size};
+    }
+
+    template<class T, size_t i = 0, class In, class ... Args>
+    static plain_value<T> take_tuple_construct(In &in, Args &... args)
+    {
+        if constexpr (take<plain_value<tuple_element_t<T, i>>>::useReference)
+        {
+            plain_value<tuple_element_t<T, i>> el;
+            take_f<plain_value<tuple_element_t<T, i>>>(in, el);
+            if constexpr (i + 1 < tuple_size_v<plain_value<T>>)
+            {
+                return take_tuple_construct<T, i + 1>(in, args..., el);
+            }
+            else
+            {
+                return {std::move(args)..., std::move(el)};
+            }
+        }
+        else
+        {
+            auto el = take_f<plain_value<tuple_element_t<T, i>>>(in);
+            if constexpr (i + 1 < tuple_size_v<plain_value<T>>)
+            {
+                return take_tuple_construct<T, i + 1>(in, args..., el);
+            }
+            else
+            {
+                return {std::move(args)..., std::move(el)};
+            }
+        }
+
+    }
+
+    template<class T, size_t i = 0, class In>
+    static void take_tuple_set(In &in, T &tuple)
+    {
+        if constexpr (take<plain_value<tuple_element_t<T, i>>>::useReference)
+        {
+            take_f<plain_value<tuple_element_t<T, i>>>(in, tuple_get_f<T, i>(tuple));
+            if constexpr (i + 1 < tuple_size_v<plain_value<T>>)
+            {
+                take_tuple_set<T, i + 1>(in, tuple);
+            }
+        }
+        else
+        {
+            tuple_get_f<T, i>(tuple) = take_f<plain_value<tuple_element_t<T, i>>>(in);
+            if constexpr (i + 1 < tuple_size_v<plain_value<T>>)
+            {
+                take_tuple_set<T, i + 1>(in, tuple);
+            }
+        }
+
+    }
+
+    template<class T>
+    struct take<T, std::enable_if_t<priority_type<T>() == Tuple>>
+    {
+        static constexpr bool useReference = !tuple_has_const_v<T>;
+
+        template<class In>
+        static constexpr plain_value<T> get(In &in)
+        {
+            if constexpr (fixed_byte_size_v<T> > 0)
+            {
+                char buffer[fixed_byte_size_v<T>];
+                auto fixedIn = take_fixed_input<T>(in, buffer);
+                return take_tuple_construct<T>(fixedIn);
+            }
+            else
+            {
+                return take_tuple_construct<T>(in);
+            }
+        }
+
+        template<class In>
+        static constexpr void get(In &in, plain_value<T> &val)
+        {
+            if constexpr (is_bytewise_v<T>)
+            {
+                in.take(&val, sizeof(val));
+            }
+            else if constexpr (fixed_byte_size_v<T> > 0)
+            {
+                char buffer[fixed_byte_size_v<T>];
+                auto fixedIn = take_fixed_input<T>(in, buffer);
+                take_tuple_set(fixedIn, val);
+            }
+            else
+            {
+                take_tuple_set(in, val);
+            }
+        }
+    };
+
+    //Reserve space for elements about to be inserted (e.g. to avoid rehashing of unordered containers)
+    template<class T, class In>
+    static void reserve_for(In &in, T &val, size_t count)
+    {
+        if constexpr (is_reservable_v<T>)
+        {
+            //Size of data read from a stream is unknown, so the count can't be validated and is trusted only partially
+            if (in.available() == std::numeric_limits<size_t>::max() && count > Serialization::streamBufferSize)
+            {
+                count = Serialization::streamBufferSize;
+            }
+            val.reserve(std::size(val) + count);
+        }
+    }
+
+    template<class T>
+    struct take<T, std::enable_if_t<priority_type<T>() == Iterable>>
+    {
+        static constexpr bool useReference = true;
+
+        template<class In>
+        static constexpr void get(In &in, plain_value<T> &val)
+        {
+            typedef typename plain_value<T>::value_type value_type;
+            auto size = take_size<typename plain_value<T>::size_type>(in);
+            check_size(in, size, byte_minsize_v<value_type>);
+            if constexpr (!is_map_v<plain_value<T>> && take<value_type>::useReference && is_resizable_v<T>)
+            {
+                //Size of data read from a stream is unknown, so the count can't be validated and container is grown
+                //by chunks of elements taking up to the buffer size as they are read
+                auto chunk = size;
+                if (in.available() == std::numeric_limits<size_t>::max())
+                {
+                    chunk = std::max<size_t>(Serialization::streamBufferSize / sizeof(value_type), 1);
+                }
+                size_t done = 0;
+                do
+                {
+                    auto next = done + (size - done < chunk ? size - done : chunk);
+                    val.resize(next);
+                    auto it = std::begin(val);
+                    if constexpr (std::is_base_of_v<std::bidirectional_iterator_tag,
+                                  typename std::iterator_traits<decltype(it)>::iterator_category>)
+                    {
+                        it = std::prev(std::end(val), ptrdiff_t(next - done));
+                    }
+                    else
+                    {
+                        it = std::next(it, ptrdiff_t(done));
+                    }
+                    for (; it != std::end(val); ++it)
+                    {
+                        take_f<value_type>(in, *it);
+                    }
+                    done = next;
+                } while (done < size);
+            }
+            else
+            {
+                reserve_for(in, val, size);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    take_insert(in, val);
+                }
+            }
+        }
+    };
+
+    // Skip
+
+    template<class In>
+    static void skip_bytes(In &in, size_t size)
+    {
+        if (size > 0 && !in.borrow(size))
+        {
+            char buffer[256];
+            for (size_t chunk; size > 0; size -= chunk)
+            {
+                chunk = std::min(size, sizeof(buffer));
+                in.take(buffer, chunk);
+            }
+        }
+    }
+
+    template<class T, size_t ... i, class In>
+    static void skip_tuple(In &in, std::index_sequence<i...>)
+    {
+        (skip_f<tuple_element_t<T, i>>(in), ...);
+    }
+
+    //Skip a value, decoding only size prefixes where possible
+    template<class T, class In>
+    static void skip_f(In &in)
+    {
+        typedef plain_value<T> value_type;
+        constexpr auto type = priority_type<value_type>();
+        if constexpr (is_fixed_size_v<value_type>)
+        {
+            skip_bytes(in, byte_minsize_v<value_type>);
+        }
+        else if constexpr (type == ArithmeticContiguous || type == ArithmeticView)
+        {
+            typedef std::remove_cv_t<std::remove_pointer_t<decltype(std::data(ldeclval<value_type>()))>> element_type;
+            auto length = take_size<decltype(std::size(ldeclval<value_type>()))>(in);
+            check_size(in, length, sizeof(element_type));
+            skip_bytes(in, length * sizeof(element_type));
+        }
+        else if constexpr (type == Iterable)
+        {
+            typedef typename value_type::value_type element_type;
+            auto length = take_size<decltype(std::size(ldeclval<value_type>()))>(in);
+            check_size(in, length, byte_minsize_v<element_type>);
+            if constexpr (is_fixed_size_v<element_type>)
+            {
+                skip_bytes(in, length * byte_minsize_v<element_type>);
+            }
+            else
+            {
+                for (size_t i = 0; i < length; ++i)
+                {
+                    skip_f<element_type>(in);
+                }
+            }
+        }
+        else if constexpr (type == Tuple)
+        {
+            skip_tuple<value_type>(in, std::make_index_sequence<tuple_size_v<value_type>>());
+        }
+        else if constexpr (type == Array)
+        {
+            for (size_t i = 0; i < std::extent_v<value_type>; ++i)
+            {
+                skip_f<std::remove_extent_t<value_type>>(in);
+            }
+        }
+        else
+        {
+            //Variable length integers and packed or delta packed blocks have to be decoded to find their end
+            take_value<value_type>(in);
+        }
+    }
+
+    // Resumable reading
+
+    //Lack of received data, found by skipping over it, with the minimal amount of bytes missing
+    struct incomplete_data
+    {
+        size_t missing;
+    };
+
+    //Input over data received by a resumable reader. While probing, amount of data to come is unknown and its lack is
+    //reported by incomplete_data. While decoding, data is never borrowed as it isn't kept after that
+    class received_input
+    {
+    public:
+        received_input(const char *ptr, size_t size, bool probing) : ptr(ptr), rest(size), size(size), probing(probing)
+        {}
+
+        void take(void *dst, size_t count)
+        {
+            auto src = next(count);
+            if (count > 0)
+            {
+                memcpy(dst, src, count);
+            }
+        }
+
+        const char *borrow(size_t count)
+        {
+            return probing ? next(count) : nullptr;
+        }
+
+        const char *peek(size_t count) const
+        {
+            return rest >= count ? ptr : nullptr;
+        }
+
+        void skip(size_t count)
+        {
+            ptr += count;
+            rest -= count;
+        }
+
+        size_t available() const
+        {
+            return probing ? std::numeric_limits<size_t>::max() : rest;
+        }
+
+        //Size of the data taken or skipped
+        size_t used() const
+        {
+            return size - rest;
+        }
+
+    private:
+        const char *next(size_t count)
+        {
+            if (rest < count)
+            {
+                if (probing)
+                {
+                    throw incomplete_data {count - rest};
+                }
+                throw Serialization::DeserializationError("Provided serialized data size is too small");
+            }
+            auto ret = ptr;
+            ptr += count;
+            rest -= count;
+            return ret;
+        }
+
+        const char *ptr;
+        size_t rest;
+        size_t size;
+        bool probing;
+    };
+
+    // Parallel
+
+    //Minimal amount of elements of a container measured and written by a single thread
+    static constexpr size_t parallelChunkSize = 1024;
+
+    template<class T, class = void>
+    struct is_parallel_serializable : std::false_type
+    {
+    };
+
+    template<class T>
+    struct is_parallel_serializable<T, std::enable_if_t<priority_type<T>() == Iterable>>
+        : std::is_base_of<std::random_access_iterator_tag,
+                          typename std::iterator_traits<decltype(std::begin(ldeclval<const T>()))>::iterator_category>
+    {
+    };
+
+    template<class T>
+    static constexpr bool is_parallel_serializable_v = is_parallel_serializable<T>::value;
+
+    //Run func(i) for every i below count on it's own thread, the calling thread runs the last one
+    template<class Func>
+    static void run_parallel(size_t count, const Func &func)
+    {
+        std::vector<std::exception_ptr> errors(count);
+        auto guarded = [&func, &errors](size_t i)
+        {
+            try
+            {
+                func(i);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(count - 1);
+        try
+        {
+            for (size_t i = 0; i + 1 < count; ++i)
+            {
+                threads.emplace_back(guarded, i);
+            }
+        }
+        catch (...)
+        {
+            for (auto &i : threads)
+            {
+                i.join();
+            }
+            throw;
+        }
+        guarded(count - 1);
+        for (auto &i : threads)
+        {
+            i.join();
+        }
+        for (auto &i : errors)
+        {
+            if (i)
+            {
+                std::rethrow_exception(i);
+            }
+        }
+    }
+
+    template<class T, class = void>
+    struct is_parallel_deserializable : std::false_type
+    {
+    };
+
+    template<class T>
+    struct is_parallel_deserializable<T, std::enable_if_t<is_parallel_serializable_v<T> && is_resizable_v<T>>>
+        : std::is_lvalue_reference<decltype(*std::begin(ldeclval<T>()))>
+    {
+    };
+
+    template<class T>
+    static constexpr bool is_parallel_deserializable_v = is_parallel_deserializable<T>::value;
+
+    //Resolve requested amount of threads, 0 means the amount of hardware threads
+    static size_t thread_count(size_t threads)
+    {
+        if (threads == 0)
+        {
+            threads = std::thread::hardware_concurrency();
+        }
+        return threads ? threads : 1;
+    }
+
+    //Run func(i) for every i below count, spreading consecutive ranges of i between up to threads threads
+    template<class Func>
+    static void run_chunks(size_t count, size_t threads, const Func &func)
+    {
+        auto workers = std::max(std::min(count, threads), size_t(1));
+        run_parallel(workers, [count, workers, &func](size_t worker)
+        {
+            for (auto i = count * worker / workers, end = count * (worker + 1) / workers; i < end; ++i)
+            {
+                func(i);
+            }
+        });
+    }
+
+    /*
+     * Serialize a random access container to the end of provided container, measuring and writing chunks of
+     * chunkSize elements in parallel, returns offsets of the chunks from the start of serialized data followed by
+     * it's size
+     */
+    template<class Container, class T>
+    static std::vector<size_t> append_chunks(Container &buffer, const T &val, size_t chunkSize, size_t threads)
+    {
+        auto length = std::size(val);
+        auto chunks = (length + chunkSize - 1) / chunkSize;
+        auto chunkBegin = [&val, length, chunkSize](size_t i)
+        {
+            return std::next(std::begin(val), ptrdiff_t(std::min(length, i * chunkSize)));
+        };
+        //Chunks are measured first, then prefix sums give the offsets where they are written
+        std::vector<size_t> offsets(chunks + 1);
+        offsets[0] = size_byte_size<decltype(std::size(val))>(length);
+        run_chunks(chunks, threads, [&offsets, &chunkBegin](size_t i)
+        {
+            size_t size = 0;
+            for (auto it = chunkBegin(i), end = chunkBegin(i + 1); it != end; ++it)
+            {
+                size += byte_size_f(*it);
+            }
+            offsets[i + 1] = size;
+        });
+        for (size_t i = 1; i <= chunks; ++i)
+        {
+            offsets[i] += offsets[i - 1];
+        }
+        auto start = std::size(buffer);
+        buffer.resize(start + offsets[chunks]);
+        auto ptr = std::data(buffer) + start;
+        auto sizePtr = ptr;
+        append_size<decltype(std::size(val))>(sizePtr, length);
+        run_chunks(chunks, threads, [ptr, &offsets, &chunkBegin](size_t i)
+        {
+            auto out = ptr + offsets[i];
+            for (auto it = chunkBegin(i), end = chunkBegin(i + 1); it != end; ++it)
+            {
+                append_f(out, *it);
+            }
+        });
+        return offsets;
+    }
+
+    // Index
+
+    //Elements per chunk of an index written by appendDataIndexed()
+    static constexpr size_t indexChunkSize = parallelChunkSize;
+    static constexpr uint32_t indexMagic = 0x58495253;
+    static constexpr uint32_t indexVersion = 1;
+    static constexpr size_t indexTrailerSize = 2 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+    template<class V>
+    static void put_fixed(char *&ptr, V val)
+    {
+        val = reorder<V, Host, order>(val);
+        memcpy(ptr, &val, sizeof(val));
+        ptr += sizeof(val);
+    }
+
+    template<class V>
+    static V take_fixed(const char *&ptr)
+    {
+        V val;
+        memcpy(&val, ptr, sizeof(val));
+        ptr += sizeof(val);
+        return reorder<V, order, Host>(val);
+    }
+
+public:
+
+    /*!
+     * Get serializer type of a type
+     * @tparam T Type to get type of
+     */
+    template<class T>
+    static constexpr ValueType priorityType = priority_type<T>();
+
+    /*!
+     * Check if serialized size of a type is known at compile time, e.g. of arithmetic values, enums, arrays of them
+     * and custom serializable structures made only of such values
+     * @tparam T Type to check
+     */
+    template<class T>
+    static constexpr bool isFixedSize = is_fixed_size_v<T>;
+
+    /*!
+     * Get serialized size of a type known at compile time
+     * @tparam T Serializable type
+     * @note Equals 0 if serialized size depends on the value
+     */
+    template<class T>
+    static constexpr size_t fixedByteSize = fixed_byte_size_v<T>;
+
+    /*!
+     * Check if a type is serialized exactly as it's stored in memory, so arrays and contiguous containers of it are
+     * copied with a single memcpy
+     * @tparam T Type to check
+     * @note Custom serializable structures qualify in host byte order if they are trivially copyable, have no padding
+     * and list all their fields in declaration order
+     */
+    template<class T>
+    static constexpr bool isBytewise = is_bytewise_v<T>;
+
+    /*!
+     * Serialize value into provided memory chunk
+     * @tparam T Serializable value type
+     * @param ptr Pointer to provided memory chunk
+     * @param val Value to serialize
+     * @note Provided memory chunk must be bigger than or equal to result of byteSize(val)
+     */
+    template<class T>
+    static void writeData(char *ptr, const T &val)
+    {
+        append_f(ptr, val);
+    }
+
+    /*!
+     * Serialize multiple values into provided memory chunk
+     * @tparam T First serializable value type
+     * @tparam Args Rest of serializable value types
+     * @param ptr Pointer to provided memory chunk
+     * @param val First value to serialize
+     * @param args Rest of the values to be serialized
+     * @note Provided memory chunk must be bigger than or equal to result of byteSize(val, args...)
+     */
+    template<class T, class ... Args>
+    static void writeData(char *ptr, const T &val, const Args &... args)
+    {
+        append_f(ptr, val);
+        writeData(ptr, args...);
+    }
+
+    /*!
+     * Serialize multiple values into provided memory chunk of limited capacity in a single pass
+     * @tparam Args Serializable value types
+     * @param ptr Pointer to provided memory chunk
+     * @param capacity Size of provided memory chunk
+     * @param args Values to serialize
+     * @return Size of serialized data, if it is bigger than capacity then data didn't fit and memory chunk contents
+     * are unspecified, retry with a chunk of at least returned size
+     */
+    template<class ... Args>
+    static size_t tryWriteData(char *ptr, size_t capacity, const Args &... args)
+    {
+        Serialization::BoundedOutput out(ptr, capacity);
+        (append_f(out, args), ...);
+        return out.size();
+    }
+
+    /*!
+     * Deserialize value from provided memory chunk
+     * @tparam Serializable value type
+     * @param ptr Pointer to provided memory chunk
+     * @param size Size of provided memory chunk
+     * @return Deserialized value
+     */
+    template<class T>
+    static T readData(const char *ptr, size_t size)
+    {
+        Serialization::MemoryInput in(ptr, size);
+        return take_value<T>(in);
+    }
+
+    /*!
+     * Deserialize multiple values from provided memory chunk
+     * @tparam Args Serializable value types
+     * @param ptr Pointer to provided memory chunk
+     * @param size Size of provided memory chunk
+     * @param args Deserialized values will be saved in respective values
+     */
+    template<class ... Args>
+    static void readData(const char *ptr, size_t size, Args &... args)
+    {
+        Serialization::MemoryInput in(ptr, size);
+        (take_into(in, args), ...);
+    }
+
+    /*!
+     * Deserialize value from a sequence of memory chunks
+     * @tparam T Serializable value type
+     * @tparam Segments Range of segments, either iovec structures or contiguous containers of chars
+     * (e.g. std::vector<std::string_view>)
+     * @param segments Segments of serialized data in order
+     * @return Deserialized value
+     * @note Data of values within a single segment is used in place, as by readData(), so views may point into it,
+     * data crossing segment boundaries is copied
+     */
+    template<class T, class Segments>
+    static T readSegments(const Segments &segments)
+    {
+        Serialization::SegmentedInput in(std::begin(segments), std::end(segments));
+        return take_value<T>(in);
+    }
+
+    /*!
+     * Deserialize multiple values from a sequence of memory chunks
+     * @tparam Segments Range of segments, either iovec structures or contiguous containers of chars
+     * (e.g. std::vector<std::string_view>)
+     * @tparam Args Serializable value types
+     * @param segments Segments of serialized data in order
+     * @param args Deserialized values will be saved in respective values
+     * @note Data of values within a single segment is used in place, as by readData(), so views may point into it,
+     * data crossing segment boundaries is copied
+     */
+    template<class Segments, class ... Args>
+    static void readSegments(const Segments &segments, Args &... args)
+    {
+        Serialization::SegmentedInput in(std::begin(segments), std::end(segments));
+        (take_into(in, args), ...);
+    }
+
+#if defined(__cpp_lib_memory_resource)
+
+    /*!
+     * Deserialize value from provided memory chunk, allocating it's memory from a memory resource
+     * @tparam T Serializable value type using polymorphic allocators
+     * (e.g. std::pmr::map<std::pmr::string, std::pmr::vector<std::pmr::string>>)
+     * @param ptr Pointer to provided memory chunk
+     * @param size Size of provided memory chunk
+     * @param resource Memory resource, e.g. std::pmr::monotonic_buffer_resource living as long as a request
+     * @return Deserialized value
+     * @note The resource is passed to all nested containers and strings constructed during deserialization, the same
+     * way values deserialized by reference pass their own stateful allocators
+     */
+    template<class T>
+    static T readData(const char *ptr, size_t size, std::pmr::memory_resource *resource)
+    {
+        static_assert(std::uses_allocator_v<T, std::pmr::polymorphic_allocator<char>>,
+                      "Value must use a polymorphic allocator");
+        Serialization::MemoryInput in(ptr, size);
+        auto val = make_with_allocator<T>(std::pmr::polymorphic_allocator<char>(resource));
+        take_into(in, val);
+        return val;
+    }
+
+#endif
+
+    /*!
+     * Deserialize a value written by appendDataIndexed() using multiple threads
+     * @tparam T Serializable value type
+     * @param ptr Pointer to provided memory chunk
+     * @param size Size of provided memory chunk
+     * @param val Deserialized value will be saved here
+     * @param threads Maximal amount of threads to use, 0 means the amount of hardware threads
+     * @note Resizable random access container (e.g. std::vector of custom serializable structures) is resized first,
+     * then chunks of it's elements are decoded into it by separate threads, other values are deserialized by the
+     * calling thread
+     * @throw Serialization::DeserializationError if data has no index of a supported version or index doesn't match
+     * the data
+     */
+    template<class T>
+    static void readDataIndexed(const char *ptr, size_t size, T &val, size_t threads = 0)
+    {
+        if (size < indexTrailerSize)
+        {
+            throw Serialization::DeserializationError("Provided serialized data has no index");
+        }
+        auto trailer = ptr + size - indexTrailerSize;
+        auto chunkSize = take_fixed<uint64_t>(trailer);
+        auto chunks = take_fixed<uint64_t>(trailer);
+        auto version = take_fixed<uint32_t>(trailer);
+        if (take_fixed<uint32_t>(trailer) != indexMagic || version != indexVersion)
+        {
+            throw Serialization::DeserializationError("Provided serialized data has no index of a supported version");
+        }
+        if (chunks > (size - indexTrailerSize) / sizeof(uint64_t))
+        {
+            throw Serialization::DeserializationError("Index of serialized data is malformed");
+        }
+        auto dataSize = size - indexTrailerSize - chunks * sizeof(uint64_t);
+        if constexpr (is_parallel_deserializable_v<T>)
+        {
+            if (chunks > 0)
+            {
+                Serialization::MemoryInput in(ptr, dataSize);
+                auto length = take_size<decltype(std::size(val))>(in);
+                check_size(in, length, byte_minsize_v<typename T::value_type>);
+                if (chunkSize == 0 || chunks != length / chunkSize + (length % chunkSize != 0))
+                {
+                    throw Serialization::DeserializationError("Index of serialized data doesn't match it");
+                }
+                std::vector<size_t> offsets(chunks + 1);
+                auto index = ptr + dataSize;
+                for (size_t i = 0; i < chunks; ++i)
+                {
+                    offsets[i] = take_fixed<uint64_t>(index);
+                }
+                offsets[chunks] = dataSize;
+                for (size_t i = 0; i < chunks; ++i)
+                {
+                    if (offsets[i] > offsets[i + 1] || (i == 0 && offsets[i] != dataSize - in.available()))
+                    {
+                        throw Serialization::DeserializationError("Index of serialized data doesn't match it");
+                    }
+                }
+                val.resize(length);
+                threads = chunks > 1 ? thread_count(threads) : 1;
+                run_chunks(chunks, threads, [ptr, length, chunkSize, chunks, &offsets, &val](size_t i)
+                {
+                    Serialization::MemoryInput chunkIn(ptr + offsets[i], offsets[i + 1] - offsets[i]);
+                    auto it = std::next(std::begin(val), ptrdiff_t(i * chunkSize));
+                    auto end = std::next(std::begin(val), ptrdiff_t(i + 1 == chunks ? length : (i + 1) * chunkSize));
+                    for (; it != end; ++it)
+                    {
+                        take_into(chunkIn, *it);
+                    }
+                    if (chunkIn.available() != 0)
+                    {
+                        throw Serialization::DeserializationError("Index of serialized data doesn't match it");
+                    }
+                });
+                return;
+            }
+        }
+        readData(ptr, dataSize, val);
+    }
+
+    /*!
+     * Get byte size of a value after serialization
+     * @tparam T Serializable value type
+     * @param val Value to measure size of
+     * @return Expected size of provided value after serialization
+     */
+    template<class T>
+    static constexpr size_t byteSize(const T &val)
+    {
+        return byte_size_f(val);
+    }
+
+    /*!
+     * Get a summed byte size of multiple values after serialization
+     * @tparam T First serializable value type
+     * @tparam Args Rest of serializable value types
+     * @param val first value to measure size of
+     * @param args Rest of values to measure size of
+     * @return
+     */
+    template<class T, class ... Args>
+    static constexpr size_t byteSize(const T &val, const Args &... args)
+    {
+        return byte_size_f(val) + byteSize(args...);
+    }
+
+    /*!
+     * Serialize multiple values
+     * @tparam Args Serializable values types
+     * @param args Serializable values
+     * @return Vector with serialized data
+     */
+    template<class ... Args>
+    static std::vector<char> serialize(Args &... args)
+    {
+        std::vector<char> ret(byteSize(args...));
+        writeData(ret.data(), args...);
+        return ret;
+    }
+
+    /*!
+     * Serialize multiple values in a single pass, without calculating their size beforehand
+     * @tparam Args Serializable values types
+     * @param args Serializable values
+     * @return Vector with serialized data
+     * @note Output vector grows geometrically, so it's capacity may exceed it's size
+     */
+    template<class ... Args>
+    static std::vector<char> serializeSinglePass(const Args &... args)
+    {
+        std::vector<char> ret;
+        appendData(ret, args...);
+        return ret;
+    }
+
+    /*!
+     * Serialize multiple values to the end of provided container
+     * @tparam Container Contiguous container of chars (e.g. std::vector<char>, std::string or Serialization::Buffer)
+     * @tparam Args Serializable values types
+     * @param buffer Container to append serialized data to, it's capacity is reused between calls
+     * @param args Serializable values
+     */
+    template<class Container, class ... Args>
+    static void appendData(Container &buffer, const Args &... args)
+    {
+        Serialization::ContainerOutput<Container> out(buffer);
+        (append_f(out, args), ...);
+        out.finish();
+    }
+
+    /*!
+     * Serialize a value to the end of provided container using multiple threads
+     * @tparam Container Contiguous container of chars (e.g. std::vector<char>, std::string or Serialization::Buffer)
+     * @tparam T Serializable value type
+     * @param buffer Container to append serialized data to
+     * @param val Value to serialize
+     * @param threads Maximal amount of threads to use, 0 means the amount of hardware threads
+     * @note Elements of a random access container (e.g. std::vector of custom serializable structures) are measured
+     * and then written to disjoint ranges of the container by separate threads, other values are serialized by the
+     * calling thread. Data is the same as of appendData()
+     * @note Use Serialization::Buffer to avoid zero filling of the container by the calling thread before writing
+     */
+    template<class Container, class T>
+    static void appendDataParallel(Container &buffer, const T &val, size_t threads = 0)
+    {
+        if constexpr (is_parallel_serializable_v<T>)
+        {
+            auto length = std::size(val);
+            threads = length >= 2 * parallelChunkSize ? thread_count(threads) : 1;
+            if (threads > 1)
+            {
+                append_chunks(buffer, val, std::max(parallelChunkSize, (length + threads - 1) / threads), threads);
+                return;
+            }
+        }
+        appendData(buffer, val);
+    }
+
+    /*!
+     * Serialize a value using multiple threads
+     * @tparam T Serializable value type
+     * @param val Value to serialize
+     * @param threads Maximal amount of threads to use, 0 means the amount of hardware threads
+     * @return Vector with serialized data, the same as of serialize()
+     * @note See appendDataParallel() for values which are serialized in parallel
+     */
+    template<class T>
+    static std::vector<char> serializeParallel(const T &val, size_t threads = 0)
+    {
+        std::vector<char> ret;
+        appendDataParallel(ret, val, threads);
+        return ret;
+    }
+
+    /*!
+     * Serialize a value to the end of provided container followed by an index, which allows to deserialize it in
+     * parallel with readDataIndexed()
+     * @tparam Container Contiguous container of chars (e.g. std::vector<char>, std::string or Serialization::Buffer)
+     * @tparam T Serializable value type
+     * @param buffer Container to append serialized data to
+     * @param val Value to serialize
+     * @param threads Maximal amount of threads to use, 0 means the amount of hardware threads
+     * @note Data is the same as of appendData(), followed by offsets of every chunk of 1024 elements of a random
+     * access container from the start of the data and a trailer: elements per chunk and amount of offsets as 64 bit
+     * integers, format version and magic as 32 bit integers, all in serializer byte order. Index of other values is
+     * empty
+     */
+    template<class Container, class T>
+    static void appendDataIndexed(Container &buffer, const T &val, size_t threads = 0)
+    {
+        auto start = std::size(buffer);
+        std::vector<size_t> offsets;
+        if constexpr (is_parallel_serializable_v<T>)
+        {
+            threads = std::size(val) > indexChunkSize ? thread_count(threads) : 1;
+            offsets = append_chunks(buffer, val, indexChunkSize, threads);
+            offsets.pop_back();
+        }
+        else
+        {
+            appendData(buffer, val);
+        }
+        auto end = std::size(buffer);
+        buffer.resize(end + offsets.size() * sizeof(uint64_t) + indexTrailerSize);
+        auto ptr = std::data(buffer) + end;
+        for (auto i : offsets)
+        {
+            put_fixed(ptr, uint64_t(i - start));
+        }
+        put_fixed(ptr, uint64_t(indexChunkSize));
+        put_fixed(ptr, uint64_t(offsets.size()));
+        put_fixed(ptr, indexVersion);
+        put_fixed(ptr, indexMagic);
+    }
+
+    /*!
+     * Serialize a value followed by an index, which allows to deserialize it in parallel
+     * @tparam T Serializable value type
+     * @param val Value to serialize
+     * @param threads Maximal amount of threads to use, 0 means the amount of hardware threads
+     * @return Vector with serialized data and index, see appendDataIndexed()
+     */
+    template<class T>
+    static std::vector<char> serializeIndexed(const T &val, size_t threads = 0)
+    {
+        std::vector<char> ret;
+        appendDataIndexed(ret, val, threads);
+        return ret;
+    }
+
+    /*!
+     * Serialize multiple values to a sink through a fixed size buffer
+     * @tparam Sink Callable with signature void(const char *data, size_t size), which consumes the whole data
+     * @tparam Args Serializable values types
+     * @param sink Sink receiving serialized data in chunks
+     * @param args Serializable values
+     * @note Produces the same data as writeData(), but memory usage is limited by Serialization::streamBufferSize
+     */
+    template<class Sink, class ... Args>
+    static void writeCallback(Sink sink, const Args &... args)
+    {
+        Serialization::StreamOutput<Sink> out(std::move(sink));
+        (append_f(out, args), ...);
+        out.flush();
+    }
+
+    /*!
+     * Serialize multiple values to an output stream
+     * @tparam Args Serializable values types
+     * @param stream Output stream, should be opened in binary mode
+     * @param args Serializable values
+     */
+    template<class ... Args>
+    static void writeStream(std::ostream &stream, const Args &... args)
+    {
+        writeCallback(Serialization::OstreamSink {stream}, args...);
+    }
+
+#if __has_include(<unistd.h>)
+
+    /*!
+     * Serialize multiple values to a file descriptor
+     * @tparam Args Serializable values types
+     * @param fd File descriptor, e.g. of a file, pipe or socket
+     * @param args Serializable values
+     */
+    template<class ... Args>
+    static void writeDescriptor(int fd, const Args &... args)
+    {
+        writeCallback(Serialization::DescriptorSink {fd}, args...);
+    }
+
+#endif
+
+#if __has_include(<sys/uio.h>)
+
+    /*!
+     * Serialize multiple values into a list of segments for scatter-gather writing
+     * @tparam Args Serializable values types
+     * @param out Output collecting the segments
+     * @param args Serializable values
+     * @note Contiguous data stored as serialized (e.g. of std::string or std::vector<char>) of at least the output's
+     * threshold is referenced in place, so values must stay alive and unchanged until the segments are written
+     */
+    template<class ... Args>
+    static void appendGather(Serialization::GatherOutput &out, const Args &... args)
+    {
+        (append_f(out, args), ...);
+    }
+
+#if __has_include(<unistd.h>)
+
+    /*!
+     * Serialize multiple values to a file descriptor with writev(), without copying big contiguous data
+     * @tparam Args Serializable values types
+     * @param fd File descriptor, e.g. of a file, pipe or socket
+     * @param args Serializable values
+     * @note Produces the same data as writeDescriptor()
+     */
+    template<class ... Args>
+    static void writeGather(int fd, const Args &... args)
+    {
+        Serialization::GatherOutput out;
+        appendGather(out, args...);
+        auto segments = out.segments();
+        Serialization::DescriptorSink {fd}(segments.data(), segments.size());
+    }
+
+#endif
+
+#endif
+
+    /*!
+     * Deserialize multiple values from a source through a fixed size buffer
+     * @tparam Source Callable with signature size_t(char *data, size_t size), which reads up to size bytes and
+     * returns their amount, 0 means the end of data
+     * @tparam Args Serializable value types
+     * @param source Source of serialized data
+     * @param args Deserialized values will be saved in respective values
+     * @note Source is read ahead by up to Serialization::streamBufferSize bytes, data which is not used is passed back
+     * to it's unread() member if it has one, see Serialization::StreamInput
+     * @note Views can't point into data which is not kept in memory, so only Serialization::ArrayView is supported
+     */
+    template<class Source, class ... Args>
+    static void readCallback(Source source, Args &... args)
+    {
+        Serialization::StreamInput<Source> in(std::move(source));
+        (take_into(in, args), ...);
+    }
+
+    /*!
+     * Deserialize multiple values from an input stream
+     * @tparam Args Serializable value types
+     * @param stream Input stream, should be opened in binary mode
+     * @param args Deserialized values will be saved in respective values
+     * @note Stream is left right after the deserialized data, so consecutive values can be read from it
+     */
+    template<class ... Args>
+    static void readStream(std::istream &stream, Args &... args)
+    {
+        readCallback(Serialization::IstreamSource {stream}, args...);
+    }
+
+#if __has_include(<unistd.h>)
+
+    /*!
+     * Deserialize multiple values from a file descriptor
+     * @tparam Args Serializable value types
+     * @param fd File descriptor, e.g. of a file, pipe or socket
+     * @param args Deserialized values will be saved in respective values
+     * @note Descriptor is read ahead by up to Serialization::streamBufferSize bytes. Seekable descriptors are rewound
+     * to the end of the deserialized data, data read ahead from others (e.g. pipes and sockets) is dropped, use
+     * StreamReader to read consecutive values from them or readDescriptorExact()
+     */
+    template<class ... Args>
+    static void readDescriptor(int fd, Args &... args)
+    {
+        readCallback(Serialization::DescriptorSource {fd}, args...);
+    }
+
+    /*!
+     * Deserialize multiple values from a file descriptor, reading exactly their data
+     * @tparam Args Serializable value types
+     * @param fd File descriptor, e.g. of a file, pipe or socket
+     * @param args Deserialized values will be saved in respective values
+     * @note Data is not read ahead, so descriptor is left right after the deserialized data, but values are read
+     * with a system call each
+     */
+    template<class ... Args>
+    static void readDescriptorExact(int fd, Args &... args)
+    {
+        Serialization::StreamInput<Serialization::DescriptorSource> in(Serialization::DescriptorSource {fd}, 0);
+        (take_into(in, args), ...);
+    }
+
+#endif
+
+#if __has_include(<sys/mman.h>)
+
+    /*!
+     * Deserialize multiple values directly from a memory mapped file
+     * @tparam Args Serializable value types
+     * @param path Path to the file
+     * @param args Deserialized values will be saved in respective values
+     * @return Mapping of the file, deserialized views point into it and stay valid as long as it's kept
+     * @throw std::system_error if file can't be opened or mapped
+     */
+    template<class ... Args>
+    static Serialization::MappedFile readFile(const std::string &path, Args &... args)
+    {
+        Serialization::MappedFile file(path);
+        readData(file.data(), file.size(), args...);
+        return file;
+    }
+
+#endif
+
+    /*!
+     * Serialize multiple values to the end of provided container, compressing them in independent blocks
+     * @tparam Container Contiguous container of chars (e.g. std::vector<char>, std::string or Serialization::Buffer)
+     * @tparam Args Serializable values types
+     * @param buffer Container to append compressed data to
+     * @param args Serializable values
+     * @note Data is compressed as it's written, without serializing it uncompressed first, see
+     * Serialization::CompressingOutput for the format
+     */
+    template<class Container, class ... Args>
+    static void appendCompressed(Container &buffer, const Args &... args)
+    {
+        Serialization::ContainerOutput<Container> out(buffer);
+        Serialization::CompressingOutput<Serialization::ContainerOutput<Container>> compressed(out);
+        (append_f(compressed, args), ...);
+        compressed.flush();
+        out.finish();
+    }
+
+    /*!
+     * Serialize multiple values, compressing them in independent blocks
+     * @tparam Args Serializable values types
+     * @param args Serializable values
+     * @return Vector with compressed data
+     */
+    template<class ... Args>
+    static std::vector<char> serializeCompressed(const Args &... args)
+    {
+        std::vector<char> ret;
+        appendCompressed(ret, args...);
+        return ret;
+    }
+
+    /*!
+     * Serialize multiple values to a sink, compressing them in independent blocks
+     * @tparam Sink Callable with signature void(const char *data, size_t size), which consumes the whole data
+     * @tparam Args Serializable values types
+     * @param sink Sink receiving compressed data in chunks
+     * @param args Serializable values
+     */
+    template<class Sink, class ... Args>
+    static void writeCompressedCallback(Sink sink, const Args &... args)
+    {
+        Serialization::StreamOutput<Sink> out(std::move(sink));
+        Serialization::CompressingOutput<Serialization::StreamOutput<Sink>> compressed(out);
+        (append_f(compressed, args), ...);
+        compressed.flush();
+        out.flush();
+    }
+
+    /*!
+     * Serialize multiple values to an output stream, compressing them in independent blocks
+     * @tparam Args Serializable values types
+     * @param stream Output stream, should be opened in binary mode
+     * @param args Serializable values
+     */
+    template<class ... Args>
+    static void writeCompressedStream(std::ostream &stream, const Args &... args)
+    {
+        writeCompressedCallback(Serialization::OstreamSink {stream}, args...);
+    }
+
+    /*!
+     * Deserialize multiple values from provided memory chunk of compressed data
+     * @tparam Args Serializable value types
+     * @param ptr Pointer to compressed data
+     * @param size Size of compressed data
+     * @param args Deserialized values will be saved in respective values
+     * @note Views can't point into decompressed data, so only Serialization::ArrayView is supported
+     */
+    template<class ... Args>
+    static void readCompressedData(const char *ptr, size_t size, Args &... args)
+    {
+        Serialization::MemoryInput in(ptr, size);
+        Serialization::DecompressingInput<Serialization::MemoryInput> decompressed(in);
+        (take_into(decompressed, args), ...);
+    }
+
+    /*!
+     * Deserialize a single value from provided vector of compressed data
+     * @tparam T Serializable value type
+     * @param data Compressed data
+     * @return Deserialized value
+     */
+    template<class T>
+    static T deserializeCompressed(const std::vector<char> &data)
+    {
+        Serialization::MemoryInput in(data.data(), data.size());
+        Serialization::DecompressingInput<Serialization::MemoryInput> decompressed(in);
+        return take_value<T>(decompressed);
+    }
+
+    /*!
+     * Deserialize multiple values from a source of compressed data
+     * @tparam Source Callable with signature size_t(char *data, size_t size), which reads up to size bytes and
+     * returns their amount, 0 means the end of data
+     * @tparam Args Serializable value types
+     * @param source Source of compressed data
+     * @param args Deserialized values will be saved in respective values
+     */
+    template<class Source, class ... Args>
+    static void readCompressedCallback(Source source, Args &... args)
+    {
+        Serialization::StreamInput<Source> in(std::move(source));
+        Serialization::DecompressingInput<Serialization::StreamInput<Source>> decompressed(in);
+        (take_into(decompressed, args), ...);
+    }
+
+    /*!
+     * Deserialize multiple values from an input stream of compressed data
+     * @tparam Args Serializable value types
+     * @param stream Input stream, should be opened in binary mode
+     * @param args Deserialized values will be saved in respective values
+     */
+    template<class ... Args>
+    static void readCompressedStream(std::istream &stream, Args &... args)
+    {
+        readCompressedCallback(Serialization::IstreamSource {stream}, args...);
+    }
+
+    /*!
+     * Deserialize a single value from provided vector
+     * @tparam T Serializable value type
+     * @param data Serialized data
+     * @return Deserialized value
+     */
+    template<class T>
+    static T deserialize(const std::vector<char> &data)
+    {
+        return readData<T>(data.data(), data.size());
+    }
+
+#if defined(__cpp_lib_memory_resource)
+
+    /*!
+     * Deserialize a single value from provided vector, allocating it's memory from a memory resource
+     * @tparam T Serializable value type using polymorphic allocators
+     * @param data Serialized data
+     * @param resource Memory resource passed to all nested containers and strings
+     * @return Deserialized value
+     */
+    template<class T>
+    static T deserialize(const std::vector<char> &data, std::pmr::memory_resource *resource)
+    {
+        return readData<T>(data.data(), data.size(), resource);
+    }
+
+#endif
+
+    /*!
+     * Deserialize multiple values
+     * @tparam T First serializable value type
+     * @tparam Args Rest of serializable value types
+     * @param data Serialized data
+     * @param val First deserialized value will be stored here
+     * @param args Rest of deserialized values will be saved in respective values
+     */
+    template<class T, class ... Args>
+    static void deserialize(const std::vector<char> &data, T &val, Args &... args)
+    {
+        readData(data.data(), data.size(), val, args...);
+    }
+
+    /*!
+     * Resumable reader of a value received in pieces, e.g. from a non-blocking socket, which decodes received data as
+     * soon as it's complete and continues from where it stopped when more data arrives
+     * @note Fields of structures and tuples, elements of arrays and of containers serialized element by element are
+     * decoded as soon as they are received, position of the first incomplete one is kept at every nesting level, so
+     * only bytes of it are checked again when more data arrives. Partially received elements of sequence containers
+     * (e.g. std::vector) are decoded in place, elements of other containers are kept until they are complete.
+     * Completeness is checked by skipping over received data, decoding only size prefixes where possible
+     * @note Received data isn't kept after decoding, so only Serialization::ArrayView views can be decoded
+     * @tparam T Serializable value type
+     */
+    template<class T>
+    class IncrementalReader
+    {
+    public:
+        IncrementalReader()
+        {
+            reset();
+        }
 
-    template<class T, size_t i = 0>
-    static void take_tuple_set(const char *&ptr, size_t &restSize, T &tuple)
-    {
-        if constexpr (take<plain_value<tuple_element_t<T, i>>>::useReference)
+        /*!
+         * Pass next received data
+         * @param ptr Pointer to received data
+         * @param size Size of received data
+         * @return Amount of bytes used, less than size only if the value is complete and the rest of the data follows it
+         * @throw Serialization::DeserializationError if data is malformed
+         */
+        size_t feed(const char *ptr, size_t size)
         {
-            take_f<plain_value<tuple_element_t<T, i>>>(ptr, restSize, tuple_get_f<T, i>(tuple));
-            if constexpr (i + 1 < tuple_size_v<plain_value<T>>)
+            if (complete)
             {
-                take_tuple_set<T, i + 1>(ptr, restSize, tuple);
+                return 0;
             }
-        }
-        else
-        {
-            tuple_get_f<T, i>(tuple) = take_f<plain_value<tuple_element_t<T, i>>>(ptr, restSize);
-            if constexpr (i + 1 < tuple_size_v<plain_value<T>>)
+            if (pending.empty())
+            {
+                //Decode directly from received data, keep only the incomplete remainder
+                auto used = decode(ptr, size);
+                if (!complete)
+                {
+                    pending.assign(ptr + used, ptr + size);
+                    used = size;
+                }
+                return used;
+            }
+            if (size < missing)
+            {
+                //Kept item is still incomplete, don't check it again
+                pending.insert(pending.end(), ptr, ptr + size);
+                missing -= size;
+                return size;
+            }
+            //Received data continues the kept incomplete item, decode them together
+            auto kept = pending.size();
+            pending.insert(pending.end(), ptr, ptr + size);
+            auto used = decode(pending.data(), pending.size());
+            if (complete)
             {
-                take_tuple_set<T, i + 1>(ptr, restSize, tuple);
+                pending.clear();
+                return used - kept;
             }
+            pending.erase(pending.begin(), pending.begin() + ptrdiff_t(used));
+            return size;
         }
 
-    }
+        //! Whether the value is completely decoded
+        bool done() const
+        { return complete; }
 
-    template<class T>
-    struct take<T, std::enable_if_t<priority_type<T>() == Tuple>>
-    {
-        static constexpr bool useReference = !tuple_has_const_v<T>;
+        //! Minimal amount of bytes needed to continue decoding, 0 if the value is complete
+        size_t needed() const
+        { return complete ? 0 : missing; }
+
+        //! Decoded value, partially filled until the value is complete
+        T &value()
+        { return val; }
 
-        static constexpr plain_value<T> get(const char *&ptr, size_t &restSize)
+        //! Start reading a new value
+        void reset()
         {
-            return take_tuple_construct<T>(ptr, restSize);
+            val = T();
+            pending.clear();
+            frames.clear();
+            complete = false;
+            missing = std::max<size_t>(byte_minsize_v<T>, 1);
         }
 
-        static constexpr void get(const char *&ptr, size_t &restSize, plain_value<T> &val)
+    private:
+        //Position of decoding of a partially received value at a nesting level
+        struct Frame
+        {
+            size_t index;           //Next field or array element, for containers 1 after the size prefix is decoded
+            size_t left;            //Elements of a container left to decode
+        };
+
+        //Values which are decoded part by part, other values are decoded only when they are completely received
+        template<class V>
+        static constexpr bool is_resumable_v = priority_type<V>() == Iterable ||
+                                               ((priority_type<V>() == Tuple || priority_type<V>() == Array) &&
+                                                take<V>::useReference && !is_fixed_size_v<V>);
+
+        //Containers whose partially received elements are decoded in place at their end
+        template<class V>
+        static constexpr bool is_appendable_v = priority_type<V>() == Iterable && !is_map_v<V> && is_resizable_v<V> &&
+                                                is_resumable_v<typename V::value_type>;
+
+        //Decode as much as possible from the start of given data, returns amount of data used
+        size_t decode(const char *ptr, size_t size)
         {
-            return take_tuple_set(ptr, restSize, val);
+            size_t used = 0;
+            complete = resume_value(val, ptr, size, used, 0);
+            return used;
         }
-    };
-
-    template<class T>
-    struct take<T, std::enable_if_t<priority_type<T>() == Iterable>>
-    {
-        static constexpr bool useReference = true;
 
-        static constexpr void get(const char *&ptr, size_t &restSize, plain_value<T> &val)
+        //Decode a value at given nesting level or continue decoding it, false if decoding stopped at an incomplete item
+        template<class V>
+        bool resume_value(V &value, const char *ptr, size_t size, size_t &used, size_t depth)
         {
-            size_type_t<typename plain_value<T>::size_type> size;
-            if constexpr(take<decltype(size)>::useReference)
+            if (frames.size() <= depth)
+            {
+                //The whole value may be received, which is the common case for small values
+                size_t count;
+                if (probe<V>(ptr + used, size - used, count))
+                {
+                    received_input in(ptr + used, count, false);
+                    take_into(in, value);
+                    used += count;
+                    return true;
+                }
+                if constexpr (is_resumable_v<V>)
+                {
+                    frames.push_back({0, 0});
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            if constexpr (is_resumable_v<V>)
             {
-                take_f<decltype(size)>(ptr, restSize, size);
+                if (!resume<V>(value, ptr, size, used, depth))
+                {
+                    return false;
+                }
+                frames.pop_back();
+                return true;
             }
             else
             {
-                size = take_f<decltype(size)>(ptr, restSize);
+                return false;
             }
-            if(size * byte_minsize_v<typename plain_value<T>::value_type> > restSize)
+        }
+
+        //Continue decoding of a value with a frame at given nesting level
+        template<class V>
+        bool resume(V &value, const char *ptr, size_t size, size_t &used, size_t depth)
+        {
+            constexpr auto type = priority_type<V>();
+            if constexpr (type == Tuple)
             {
-                throw Serialization::DeserializationError("Provided serialized data size is too small");
+                return resume_fields<V>(value, ptr, size, used, depth);
             }
-            if constexpr (take<typename plain_value<T>::value_type>::useReference)
+            else if constexpr (type == Array)
             {
-                if constexpr (is_resizable_v<T>)
+                for (; frames[depth].index < std::extent_v<V>; ++frames[depth].index)
                 {
-                    val.resize(size);
-                    for (auto &i : val)
+                    if (!resume_value(value[frames[depth].index], ptr, size, used, depth + 1))
                     {
-                        take_f<typename plain_value<T>::value_type>(ptr, restSize, i);
+                        return false;
                     }
                 }
-                else
+                return true;
+            }
+            else
+            {
+                typedef typename V::value_type element_type;
+                if (frames[depth].index == 0)
+                {
+                    received_input in(ptr + used, size - used, true);
+                    try
+                    {
+                        frames[depth].left = take_size<typename V::size_type>(in);
+                    }
+                    catch (const incomplete_data &e)
+                    {
+                        missing = e.missing;
+                        return false;
+                    }
+                    reserve_for(in, value, frames[depth].left);
+                    used += in.used();
+                    frames[depth].index = 1;
+                }
+                for (; frames[depth].left > 0; --frames[depth].left)
                 {
-                    for (size_t i = 0; i < size; ++i)
+                    if (frames.size() <= depth + 1)
+                    {
+                        size_t count;
+                        if (probe<element_type>(ptr + used, size - used, count))
+                        {
+                            received_input in(ptr + used, count, false);
+                            take_insert(in, value);
+                            used += count;
+                            continue;
+                        }
+                        if constexpr (is_appendable_v<V>)
+                        {
+                            value.resize(std::size(value) + 1);
+                            frames.push_back({0, 0});
+                        }
+                        else
+                        {
+                            return false;
+                        }
+                    }
+                    if constexpr (is_appendable_v<V>)
                     {
-                        typename plain_value<T>::value_type el;
-                        take_f<typename plain_value<T>::value_type>(ptr, restSize, el);
-                        val.insert(val.end(), el);
+                        if (!resume_value(value.back(), ptr, size, used, depth + 1))
+                        {
+                            return false;
+                        }
                     }
                 }
+                return true;
             }
-            else
+        }
+
+        template<class V, size_t i = 0>
+        bool resume_fields(V &value, const char *ptr, size_t size, size_t &used, size_t depth)
+        {
+            if constexpr (i < tuple_size_v<V>)
             {
-                for (size_t i = 0; i < size; ++i)
+                if (frames[depth].index == i)
                 {
-                    val.insert(val.end(), take_f<typename plain_value<T>::value_type>(ptr, restSize));
+                    if (!resume_value(tuple_get_f<V, i>(value), ptr, size, used, depth + 1))
+                    {
+                        return false;
+                    }
+                    ++frames[depth].index;
                 }
+                return resume_fields<V, i + 1>(value, ptr, size, used, depth);
+            }
+            else
+            {
+                return true;
             }
         }
-    };
 
-public:
+        //Check whether a value is completely received and find its size
+        template<class V>
+        bool probe(const char *ptr, size_t size, size_t &count)
+        {
+            received_input in(ptr, size, true);
+            try
+            {
+                skip_f<V>(in);
+            }
+            catch (const incomplete_data &e)
+            {
+                missing = e.missing;
+                return false;
+            }
+            count = in.used();
+            return true;
+        }
 
-    /*!
-     * Get serializer type of a type
-     * @tparam T Type to get type of
-     */
-    template<class T>
-    static constexpr ValueType priorityType = priority_type<T>();
+        T val;
+        Serialization::Buffer pending;
+        std::vector<Frame> frames;
+        bool complete;
+        size_t missing;
+    };
 
     /*!
-     * Serialize value into provided memory chunk
-     * @tparam T Serializable value type
-     * @param ptr Pointer to provided memory chunk
-     * @param val Value to serialize
-     * @note Provided memory chunk must be bigger than or equal to result of byteSize(val)
+     * Reader of consecutive values from a source through a buffer kept between reads, e.g. of messages from a pipe or
+     * socket, so data read ahead past a value is used by the next read
+     * @note Data read ahead but not used is passed back to the source when reader is destroyed, see
+     * Serialization::StreamInput
+     * @tparam Source Callable with signature size_t(char *data, size_t size), which reads up to size bytes and
+     * returns their amount, 0 means the end of data (e.g. Serialization::DescriptorSource)
      */
-    template<class T>
-    static void writeData(char *ptr, const T &val)
+    template<class Source>
+    class StreamReader
     {
-        append_f(ptr, val);
-    }
+    public:
+        /*!
+         * Create reader
+         * @param source Source of serialized data
+         * @param capacity Size of the buffer, 0 disables read ahead
+         */
+        explicit StreamReader(Source source, size_t capacity = Serialization::streamBufferSize)
+            : in(std::move(source), capacity) {}
+
+        /*!
+         * Deserialize next values
+         * @tparam Args Serializable value types
+         * @param args Deserialized values will be saved in respective values
+         * @throw Serialization::DeserializationError if source ends before the values
+         * @note Views can't point into data which is not kept in memory, so only Serialization::ArrayView is supported
+         */
+        template<class ... Args>
+        void read(Args &... args)
+        {
+            (take_into(in, args), ...);
+        }
 
-    /*!
-     * Serialize multiple values into provided memory chunk
-     * @tparam T First serializable value type
-     * @tparam Args Rest of serializable value types
-     * @param ptr Pointer to provided memory chunk
-     * @param val First value to serialize
-     * @param args Rest of the values to be serialized
-     * @note Provided memory chunk must be bigger than or equal to result of byteSize(val, args...)
-     */
-    template<class T, class ... Args>
-    static void writeData(char *ptr, const T &val, const Args &... args)
-    {
-        append_f(ptr, val);
-        writeData(ptr, args...);
-    }
+    private:
+        Serialization::StreamInput<Source> in;
+    };
 
     /*!
-     * Deserialize value from provided memory chunk
-     * @tparam Serializable value type
-     * @param ptr Pointer to provided memory chunk
-     * @param size Size of provided memory chunk
-     * @return Deserialized value
+     * Lazy reader of a serialized container, which decodes only the elements it's asked for
+     * @note Only the size prefix is parsed on construction. Elements of fixed size are located by their index in
+     * constant time, other elements are located by skipping the preceding ones once, their offsets are kept for
+     * later accesses
+     * @note Serialized data must be kept in memory as long as the reader and views decoded by it are used
+     * @tparam T Container serialized element by element, e.g. std::vector or std::map of custom serializable
+     * structures
      */
     template<class T>
-    static T readData(const char *ptr, size_t size)
+    class LazyReader
     {
-        if constexpr (take<T>::useReference)
-        {
-            plain_value<T> val;
-            take_f<T>(ptr, size, val);
-            return val;
-        }
-        else
+        static_assert(priority_type<T>() == Iterable || priority_type<T>() == ArithmeticContiguous,
+                      "Lazy reader requires a container serialized element by element");
+
+    public:
+        typedef typename T::value_type value_type;
+
+        /*!
+         * Create reader of a serialized container
+         * @param ptr Pointer to serialized data
+         * @param size Size of serialized data
+         * @throw Serialization::DeserializationError if data is too small for the container
+         */
+        LazyReader(const char *ptr, size_t size) : ptr(ptr), dataSize(size)
         {
-            return take_f<T>(ptr, size);
+            Serialization::MemoryInput in(ptr, size);
+            length = take_size<decltype(std::size(ldeclval<T>()))>(in);
+            check_size(in, length, byte_minsize_v<value_type>);
+            begin = size - in.available();
         }
-    }
 
-    /*!
-     * Deserialize value from provided memory chunk
-     * @tparam T Serializable value type
-     * @param ptr Pointer to provided memory chunk
-     * @param size Size of provided memory chunk
-     * @param val Deserialized value will be stored here
-     */
-    template<class T>
-    static void readData(const char *ptr, size_t size, T &val)
-    {
-        if constexpr (take<plain_value<T>>::useReference)
+        //! Amount of elements in the container
+        size_t size() const
+        { return length; }
+
+        bool empty() const
+        { return length == 0; }
+
+        /*!
+         * Decode an element
+         * @param i Index of the element
+         * @return Decoded element
+         * @throw std::out_of_range if index is out of range
+         */
+        value_type at(size_t i) const
         {
-            take_f<T>(ptr, size, val);
+            if (i >= length)
+            {
+                throw std::out_of_range("Lazy reader index is out of range");
+            }
+            auto in = input(i);
+            return take_value<value_type>(in);
         }
-        else
+
+        value_type operator[](size_t i) const
         {
-            val = take_f<T>(ptr, size);
+            return at(i);
         }
-    }
 
-    /*!
-     * Deserialize multiple values from provided memory chunk
-     * @tparam T First serializable value type
-     * @tparam Args Rest of serializable value types
-     * @param ptr Pointer to provided memory chunk
-     * @param size Size of provided memory chunk
-     * @param val First deserialized value will be stored here
-     * @param args Rest of deserialized values will be saved in respective values
-     */
-    template<class T, class ... Args>
-    static void readData(const char *ptr, size_t size, T &val, Args &... args)
-    {
-        if constexpr (take<plain_value<T>>::useReference)
+        /*!
+         * Decode mapped value of a serialized map by it's key
+         * @param key Key to find
+         * @return Decoded mapped value or std::nullopt if key is not found
+         * @note Ordered map is searched with binary search, which skips each element preceding the found one only
+         * once over all searches. Unordered map is scanned, decoding keys and skipping mapped values
+         */
+        template<class M = T, class = std::enable_if_t<is_map_v<M>>>
+        std::optional<typename M::mapped_type> find(const typename M::key_type &key) const
         {
-            take_f<T>(ptr, size, val);
+            typedef typename M::key_type key_type;
+            typedef typename M::mapped_type mapped_type;
+            if constexpr (is_ordered_map_v<M>)
+            {
+                typename M::key_compare less;
+                size_t low = 0;
+                size_t high = length;
+                while (low < high)
+                {
+                    auto middle = low + (high - low) / 2;
+                    auto in = input(middle);
+                    if (less(take_value<key_type>(in), key))
+                    {
+                        low = middle + 1;
+                    }
+                    else
+                    {
+                        high = middle;
+                    }
+                }
+                if (low < length)
+                {
+                    auto in = input(low);
+                    if (!less(key, take_value<key_type>(in)))
+                    {
+                        return take_value<mapped_type>(in);
+                    }
+                }
+            }
+            else
+            {
+                auto in = input(0);
+                for (size_t i = 0; i < length; ++i)
+                {
+                    if (take_value<key_type>(in) == key)
+                    {
+                        return take_value<mapped_type>(in);
+                    }
+                    skip_f<mapped_type>(in);
+                }
+            }
+            return std::nullopt;
         }
-        else
+
+    private:
+        //Input positioned at the start of an element
+        Serialization::MemoryInput input(size_t i) const
         {
-            val = take_f<T>(ptr, size);
+            size_t offset;
+            if constexpr (is_fixed_size_v<value_type>)
+            {
+                offset = begin + i * byte_minsize_v<value_type>;
+            }
+            else
+            {
+                if (offsets.empty())
+                {
+                    offsets.push_back(begin);
+                }
+                if (i >= offsets.size())
+                {
+                    Serialization::MemoryInput in(ptr + offsets.back(), dataSize - offsets.back());
+                    while (i >= offsets.size())
+                    {
+                        skip_f<value_type>(in);
+                        offsets.push_back(dataSize - in.available());
+                    }
+                }
+                offset = offsets[i];
+            }
+            return Serialization::MemoryInput(ptr + offset, dataSize - offset);
         }
-        readData(ptr, size, args...);
-    }
-
-    /*!
-     * Get byte size of a value after serialization
-     * @tparam T Serializable value type
-     * @param val Value to measure size of
-     * @return Expected size of provided value after serialization
-     */
-    template<class T>
-    static constexpr size_t byteSize(const T &val)
-    {
-        return byte_size_f(val);
-    }
-
-    /*!
-     * Get a summed byte size of multiple values after serialization
-     * @tparam T First serializable value type
-     * @tparam Args Rest of serializable value types
-     * @param val first value to measure size of
-     * @param args Rest of values to measure size of
-     * @return
-     */
-    template<class T, class ... Args>
-    static constexpr size_t byteSize(const T &val, const Args &... args)
-    {
-        return byte_size_f(val) + byteSize(args...);
-    }
-
-    /*!
-     * Serialize multiple values
-     * @tparam Args Serializable values types
-     * @param args Serializable values
-     * @return Vector with serialized data
-     */
-    template<class ... Args>
-    static std::vector<char> serialize(Args &... args)
-    {
-        std::vector<char> ret(byteSize(args...));
-        writeData(ret.data(), args...);
-        return ret;
-    }
-
-    /*!
-     * Deserialize a single value from provided vector
-     * @tparam T Serializable value type
-     * @param data Serialized data
-     * @return Deserialized value
-     */
-    template<class T>
-    static T deserialize(const std::vector<char> &data)
-    {
-        return readData<T>(data.data(), data.size());
-    }
 
-    /*!
-     * Deserialize multiple values
-     * @tparam T First serializable value type
-     * @tparam Args Rest of serializable value types
-     * @param data Serialized data
-     * @param val First deserialized value will be stored here
-     * @param args Rest of deserialized values will be saved in respective values
-     */
-    template<class T, class ... Args>
-    static void deserialize(const std::vector<char> &data, T &val, Args &... args)
-    {
-        readData(data.data(), data.size(), val, args...);
-    }
+        const char *ptr;
+        size_t dataSize;
+        size_t length;
+        size_t begin;
+        mutable std::vector<size_t> offsets;
+    };
 
 };
 
@@ -1316,6 +5672,7 @@ template <class T, size_t i, class> friend struct serializerTuple::tuple_element
             static_assert(!std::is_const_v<std::remove_reference_t<decltype(typeName::arg)>>, "Serializable parameter of a custom serializable type must not be const"); \
             static auto & func(typeName& val) { return val.arg;} \
             const static auto & func(const typeName& val) { return val.arg;} \
+            template<class U = typeName> static constexpr size_t offset() { return offsetof(U, arg);} \
         }; \
         template<> struct serializerTuple::tuple_element<typeName, pos> { typedef decltype(typeName::arg) type; }
 
@@ -1351,6 +5708,13 @@ template <class T, size_t i, class> friend struct serializerTuple::tuple_element
 
 #define _SERIALIZER_ADD_ALL_METHODS_(size, typeName, ...) CONCATENATE(_SERIALIZER_ADD_METHODS_,size)(size, typeName, __VA_ARGS__)
 
+/*!
+ * Opt a container of sorted 32 or 64 bit integers into delta encoding with bitpacking
+ * @note Must be used in global namespace
+ */
+#define DELTA_PACKED(typeName) \
+template <> struct Serialization::is_delta_packed<typeName> : std::true_type {}
+
 #define CUSTOM_SERIALIZABLE(typeName, ...) \
 template <> struct serializerTuple::is_tuple_serializable<typeName> : std::true_type {}; \
 template <> struct serializerTuple::tuple_size<typeName> { static constexpr size_t value = PP_NARG(__VA_ARGS__); } \
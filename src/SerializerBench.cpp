@@ -0,0 +1,630 @@
+// Copyright 2019 Sviatoslav Dmitriev
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+#include "Serializer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+
+// Allocation counting
+
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+static std::atomic<size_t> allocationCount {0};
+
+void *operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (auto ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// Benchmarked types
+
+enum class Side : uint8_t
+{
+    Buy,
+    Sell
+};
+
+struct Tick
+{
+    uint64_t time;
+    double price;
+    uint32_t volume;
+    Side side;
+};
+
+CUSTOM_SERIALIZABLE(Tick, time, price, volume, side);
+
+struct Level
+{
+    double price;
+    uint32_t volume;
+    uint32_t orders;
+};
+
+CUSTOM_SERIALIZABLE(Level, price, volume, orders);
+
+struct Record
+{
+    uint64_t id;
+    std::string name;
+    std::vector<double> values;
+    std::vector<Tick> ticks;
+};
+
+CUSTOM_SERIALIZABLE(Record, id, name, values, ticks);
+
+struct PostingList : std::vector<uint32_t>
+{
+    using std::vector<uint32_t>::vector;
+};
+
+DELTA_PACKED(PostingList);
+DELTA_PACKED(std::set<uint64_t>);
+
+// Harness
+
+struct Options
+{
+    size_t maxBytes = size_t(256) << 20;
+    double minTime = 0.2;
+    std::string filter;
+};
+
+struct Result
+{
+    std::string name;
+    size_t iterations;
+    double nsPerIteration;
+    double bytesPerSecond;
+    double itemsPerSecond;
+    double allocationsPerIteration;
+};
+
+class Bench
+{
+public:
+    explicit Bench(const Options &options) : options(options) {}
+
+    /*!
+     * Measure an operation
+     * @param name Benchmark name
+     * @param bytes Amount of serialized bytes processed by one call
+     * @param items Amount of objects processed by one call
+     * @param func Operation to measure
+     */
+    void run(const std::string &name, size_t bytes, size_t items, const std::function<void()> &func)
+    {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+        {
+            return;
+        }
+        func();
+        size_t iterations = 0;
+        size_t batch = 1;
+        auto allocations = allocationCount.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed {};
+        while (elapsed.count() < options.minTime)
+        {
+            for (size_t i = 0; i < batch; ++i)
+            {
+                func();
+            }
+            iterations += batch;
+            batch *= 2;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        allocations = allocationCount.load(std::memory_order_relaxed) - allocations;
+        auto seconds = elapsed.count();
+        results.push_back({name, iterations, seconds * 1e9 / double(iterations),
+                           double(bytes) * double(iterations) / seconds,
+                           double(items) * double(iterations) / seconds,
+                           double(allocations) / double(iterations)});
+        std::fprintf(stderr, "%-64s %12.0f ns %10.1f MB/s %8.2f allocs\n", name.c_str(), results.back().nsPerIteration,
+                     results.back().bytesPerSecond / 1e6, results.back().allocationsPerIteration);
+    }
+
+    //! Check if benchmark with given serialized size is enabled
+    bool fits(size_t bytes) const
+    {
+        return bytes <= options.maxBytes;
+    }
+
+    //! Print results as JSON
+    void report(FILE *file) const
+    {
+        std::fprintf(file, "{\n  \"context\": {\n    \"library\": \"Serializer\",\n    \"max_bytes\": %zu,\n"
+                           "    \"min_time\": %g\n  },\n  \"benchmarks\": [", options.maxBytes, options.minTime);
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            auto &res = results[i];
+            std::fprintf(file, "%s\n    {\"name\": \"%s\", \"iterations\": %zu, \"real_time\": %.3f, \"time_unit\": \"ns\", "
+                               "\"bytes_per_second\": %.1f, \"items_per_second\": %.1f, \"allocs_per_iter\": %.3f}",
+                         i ? "," : "", res.name.c_str(), res.iterations, res.nsPerIteration, res.bytesPerSecond,
+                         res.itemsPerSecond, res.allocationsPerIteration);
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+    }
+
+private:
+    Options options;
+    std::vector<Result> results;
+};
+
+template<class T>
+static void doNotOptimize(const T &val)
+{
+    asm volatile("" : : "r,m"(val) : "memory");
+}
+
+/*!
+ * Register serialize, append, stream and deserialize benchmarks of a single value
+ * @tparam S Serializer type
+ * @param name Benchmark name prefix
+ * @param val Value to measure
+ * @param items Amount of objects stored in the value
+ */
+template<class S, class T>
+static void benchValue(Bench &bench, const std::string &name, const T &val, size_t items)
+{
+    auto size = S::byteSize(val);
+    if (!bench.fits(size))
+    {
+        return;
+    }
+    auto suffix = "/" + std::to_string(size);
+    bench.run(name + "/serialize" + suffix, size, items, [&]
+    {
+        auto data = S::serialize(val);
+        doNotOptimize(data.data());
+    });
+    Serialization::Buffer buffer;
+    bench.run(name + "/appendData" + suffix, size, items, [&]
+    {
+        buffer.clear();
+        S::appendData(buffer, val);
+        doNotOptimize(buffer.data());
+    });
+    bench.run(name + "/writeCallback" + suffix, size, items, [&]
+    {
+        S::writeCallback([](const char *ptr, size_t) { doNotOptimize(ptr); }, val);
+    });
+    auto data = S::serialize(val);
+    bench.run(name + "/deserialize" + suffix, size, items, [&]
+    {
+        T nval;
+        S::deserialize(data, nval);
+        doNotOptimize(nval);
+    });
+    bench.run(name + "/readCallback" + suffix, size, items, [&]
+    {
+        size_t pos = 0;
+        T nval;
+        S::readCallback([&](char *ptr, size_t n)
+                        {
+                            n = n < data.size() - pos ? n : data.size() - pos;
+                            memcpy(ptr, data.data() + pos, n);
+                            pos += n;
+                            return n;
+                        }, nval);
+        doNotOptimize(nval);
+    });
+    bench.run(name + "/serializeCompressed" + suffix, size, items, [&]
+    {
+        auto compressed = S::serializeCompressed(val);
+        doNotOptimize(compressed.data());
+    });
+    auto compressed = S::serializeCompressed(val);
+    bench.run(name + "/readCompressedData" + suffix, size, items, [&]
+    {
+        T nval;
+        S::readCompressedData(compressed.data(), compressed.size(), nval);
+        doNotOptimize(nval);
+    });
+}
+
+//! Element counts of containers from tiny to hundreds of MB, limited by maximum serialized size
+static std::vector<size_t> counts(const Bench &bench, size_t elementSize)
+{
+    std::vector<size_t> ret;
+    for (size_t bytes : {size_t(64), size_t(4) << 10, size_t(1) << 20, size_t(64) << 20, size_t(256) << 20})
+    {
+        if (bench.fits(bytes))
+        {
+            ret.push_back(bytes / elementSize);
+        }
+    }
+    return ret;
+}
+
+template<class S>
+static void benchOrder(Bench &bench, const std::string &prefix)
+{
+    std::mt19937_64 rng(42);
+
+    {
+        uint64_t val = 42;
+        auto data = S::serialize(val);
+        bench.run(prefix + "/Arithmetic/serialize", data.size(), 1, [&]
+        {
+            auto ndata = S::serialize(val);
+            doNotOptimize(ndata.data());
+        });
+        bench.run(prefix + "/Arithmetic/deserialize", data.size(), 1, [&]
+        {
+            uint64_t nval;
+            S::deserialize(data, nval);
+            doNotOptimize(nval);
+        });
+    }
+
+    {
+        std::array<uint32_t, 1024> val {};
+        for (auto &i : val)
+        {
+            i = uint32_t(rng());
+        }
+        benchValue<S>(bench, prefix + "/Optimized/array<uint32_t,1024>", val, val.size());
+    }
+
+    for (auto count : counts(bench, sizeof(uint32_t) * 8))
+    {
+        std::forward_list<uint32_t> val;
+        for (size_t i = 0; i < count; ++i)
+        {
+            val.push_front(uint32_t(rng()));
+        }
+        benchValue<S>(bench, prefix + "/Optimized/forward_list<uint32_t>", val, count);
+    }
+
+    {
+        static uint32_t val[65536];
+        for (auto &i : val)
+        {
+            i = uint32_t(rng());
+        }
+        auto size = S::byteSize(val);
+        bench.run(prefix + "/ArithmeticArray/uint32_t[65536]/writeData/" + std::to_string(size), size, 65536, [&]
+        {
+            std::vector<char> data(size);
+            S::writeData(data.data(), val);
+            doNotOptimize(data.data());
+        });
+        auto data = S::serialize(val);
+        bench.run(prefix + "/ArithmeticArray/uint32_t[65536]/readData/" + std::to_string(size), size, 65536, [&]
+        {
+            static uint32_t nval[65536];
+            S::readData(data.data(), data.size(), nval);
+            doNotOptimize(nval);
+        });
+    }
+
+    for (auto count : counts(bench, sizeof(uint32_t)))
+    {
+        std::vector<uint32_t> val(count);
+        for (auto &i : val)
+        {
+            i = uint32_t(rng());
+        }
+        benchValue<S>(bench, prefix + "/ArithmeticContiguous/vector<uint32_t>", val, count);
+    }
+
+    for (auto count : counts(bench, sizeof(uint32_t)))
+    {
+        std::vector<uint32_t> val(count);
+        for (auto &i : val)
+        {
+            i = uint32_t(rng() % 65536);
+        }
+        benchValue<S>(bench, prefix + "/ArithmeticContiguous/vector<uint32_t>,small", val, count);
+    }
+
+    for (auto count : counts(bench, sizeof(uint32_t)))
+    {
+        PostingList val(count);
+        uint32_t id = 0;
+        for (auto &i : val)
+        {
+            i = id += uint32_t(rng() % 64 + 1);
+        }
+        benchValue<S>(bench, prefix + "/DeltaPacked/PostingList", val, count);
+    }
+
+    for (auto count : counts(bench, sizeof(uint64_t) * 8))
+    {
+        std::set<uint64_t> val;
+        while (val.size() < count)
+        {
+            val.insert(rng() % (count * 16));
+        }
+        benchValue<S>(bench, prefix + "/DeltaPacked/set<u64>", val, count);
+    }
+
+    for (auto count : counts(bench, sizeof(double)))
+    {
+        std::vector<double> val(count);
+        for (auto &i : val)
+        {
+            i = double(rng());
+        }
+        benchValue<S>(bench, prefix + "/ArithmeticContiguous/vector<double>", val, count);
+    }
+
+    {
+        std::string val[16];
+        for (auto &i : val)
+        {
+            i = std::string(rng() % 64, 'a');
+        }
+        bench.run(prefix + "/Array/string[16]/serialize", S::byteSize(val), 16, [&]
+        {
+            auto data = S::template serialize<decltype(val)>(val);
+            doNotOptimize(data.data());
+        });
+        auto data = S::template serialize<decltype(val)>(val);
+        bench.run(prefix + "/Array/string[16]/deserialize", data.size(), 16, [&]
+        {
+            std::string nval[16];
+            S::deserialize(data, nval);
+            doNotOptimize(nval);
+        });
+    }
+
+    {
+        std::tuple<uint8_t, uint16_t, uint32_t, uint64_t, double> val {1, 2, 3, 4, 5.0};
+        benchValue<S>(bench, prefix + "/Tuple/tuple<u8,u16,u32,u64,double>", val, 1);
+    }
+
+    for (auto count : counts(bench, 32))
+    {
+        std::vector<std::string> val(count);
+        for (auto &i : val)
+        {
+            i = std::string(rng() % 32, 'a');
+        }
+        benchValue<S>(bench, prefix + "/Iterable/vector<string>", val, count);
+    }
+
+#if __has_include(<sys/uio.h>)
+    for (auto count : counts(bench, 64 << 10))
+    {
+        std::vector<std::string> val(count, std::string(64 << 10, 'b'));
+        auto size = S::byteSize(val);
+        if (count == 0 || !bench.fits(size))
+        {
+            continue;
+        }
+        auto suffix = "/" + std::to_string(size);
+        Serialization::Buffer buffer;
+        bench.run(prefix + "/Iterable/vector<string,64K>/appendData" + suffix, size, count, [&]
+        {
+            buffer.clear();
+            S::appendData(buffer, val);
+            doNotOptimize(buffer.data());
+        });
+        Serialization::GatherOutput out;
+        bench.run(prefix + "/Iterable/vector<string,64K>/appendGather" + suffix, size, count, [&]
+        {
+            out.clear();
+            S::appendGather(out, val);
+            doNotOptimize(out.segments());
+        });
+    }
+#endif
+
+    for (auto count : counts(bench, sizeof(Tick)))
+    {
+        std::vector<Tick> val(count);
+        for (auto &i : val)
+        {
+            i = {rng(), double(rng()), uint32_t(rng()), rng() % 2 ? Side::Buy : Side::Sell};
+        }
+        benchValue<S>(bench, prefix + "/Iterable/vector<Tick>", val, count);
+    }
+
+    for (auto count : counts(bench, sizeof(Level)))
+    {
+        std::vector<Level> val(count);
+        for (auto &i : val)
+        {
+            i = {double(rng()), uint32_t(rng()), uint32_t(rng() % 64)};
+        }
+        //Copied bytewise in host order only
+        auto type = S::template priorityType<decltype(val)> == S::ArithmeticContiguous ? "/ArithmeticContiguous" : "/Iterable";
+        benchValue<S>(bench, prefix + type + "/vector<Level>", val, count);
+    }
+
+    for (auto count : counts(bench, sizeof(uint64_t) * 2))
+    {
+        std::map<uint64_t, uint64_t> val;
+        for (size_t i = 0; i < count; ++i)
+        {
+            val.emplace(rng(), rng());
+        }
+        benchValue<S>(bench, prefix + "/Iterable/map<u64,u64>", val, count);
+    }
+
+    for (auto count : counts(bench, 1024))
+    {
+        std::map<std::string, std::vector<Record>> val;
+        for (size_t i = 0; i < (count + 15) / 16; ++i)
+        {
+            auto &records = val[std::to_string(rng())];
+            for (size_t j = 0; j < 16; ++j)
+            {
+                records.push_back({rng(), std::string(rng() % 32, 'r'), std::vector<double>(rng() % 32, 1.0),
+                                   std::vector<Tick>(rng() % 32, Tick {1, 2.0, 3, Side::Buy})});
+            }
+        }
+        benchValue<S>(bench, prefix + "/Iterable/map<string,vector<Record>>", val, count);
+    }
+
+    for (auto count : counts(bench, 256))
+    {
+        std::vector<Record> val(count);
+        for (auto &i : val)
+        {
+            i = {rng(), std::string(rng() % 32, 'r'), std::vector<double>(rng() % 16, 1.0),
+                 std::vector<Tick>(rng() % 8, Tick {1, 2.0, 3, Side::Buy})};
+        }
+        auto size = S::byteSize(val);
+        if (!bench.fits(size))
+        {
+            continue;
+        }
+        auto suffix = "/" + std::to_string(size);
+        Serialization::Buffer buffer;
+        bench.run(prefix + "/Iterable/vector<Record>/appendData" + suffix, size, count, [&]
+        {
+            buffer.clear();
+            S::appendData(buffer, val);
+            doNotOptimize(buffer.data());
+        });
+        bench.run(prefix + "/Iterable/vector<Record>/appendDataParallel" + suffix, size, count, [&]
+        {
+            buffer.clear();
+            S::appendDataParallel(buffer, val);
+            doNotOptimize(buffer.data());
+        });
+        auto data = S::serialize(val);
+        bench.run(prefix + "/Iterable/vector<Record>/deserialize" + suffix, size, count, [&]
+        {
+            std::vector<Record> nval;
+            S::deserialize(data, nval);
+            doNotOptimize(nval);
+        });
+        //Data received in packets of a typical network MTU
+        std::vector<std::string_view> packets;
+        for (size_t pos = 0; pos < data.size(); pos += 1500)
+        {
+            packets.emplace_back(data.data() + pos, std::min<size_t>(1500, data.size() - pos));
+        }
+        bench.run(prefix + "/Iterable/vector<Record>/readSegments,1500" + suffix, size, count, [&]
+        {
+            std::vector<Record> nval;
+            S::readSegments(packets, nval);
+            doNotOptimize(nval);
+        });
+        bench.run(prefix + "/Iterable/vector<Record>/IncrementalReader,1500" + suffix, size, count, [&]
+        {
+            typename S::template IncrementalReader<std::vector<Record>> reader;
+            for (auto &packet : packets)
+            {
+                reader.feed(packet.data(), packet.size());
+            }
+            doNotOptimize(reader.value());
+        });
+        bench.run(prefix + "/Iterable/vector<Record>/LazyReader::at" + suffix, size, count, [&]
+        {
+            typename S::template LazyReader<std::vector<Record>> reader(data.data(), data.size());
+            if (!reader.empty())
+            {
+                auto record = reader.at(reader.size() / 2);
+                doNotOptimize(record);
+            }
+        });
+        auto indexed = S::serializeIndexed(val);
+        bench.run(prefix + "/Iterable/vector<Record>/readDataIndexed" + suffix, size, count, [&]
+        {
+            std::vector<Record> nval;
+            S::readDataIndexed(indexed.data(), indexed.size(), nval);
+            doNotOptimize(nval);
+        });
+    }
+
+#if defined(__cpp_lib_memory_resource)
+    for (auto count : counts(bench, 48))
+    {
+        typedef std::pmr::map<std::pmr::string, std::pmr::vector<std::pmr::string>> PmrMap;
+        std::map<std::string, std::vector<std::string>> val;
+        for (size_t i = 0; i < (count + 15) / 16; ++i)
+        {
+            auto &strings = val[std::string(24, 'k') + std::to_string(rng())];
+            for (size_t j = 0; j < 16; ++j)
+            {
+                strings.push_back(std::string(16 + rng() % 32, 's'));
+            }
+        }
+        auto size = S::byteSize(val);
+        if (!bench.fits(size))
+        {
+            continue;
+        }
+        auto suffix = "/" + std::to_string(size);
+        auto data = S::serialize(val);
+        //Both include destruction of the result, the arena releases it at once
+        bench.run(prefix + "/Iterable/map<string,vector<string>>/deserialize" + suffix, size, count, [&]
+        {
+            auto nval = S::template deserialize<decltype(val)>(data);
+            doNotOptimize(nval);
+        });
+        std::vector<char> arenaBuffer(size * 4);
+        bench.run(prefix + "/Iterable/map<string,vector<string>>/deserialize,arena" + suffix, size, count, [&]
+        {
+            std::pmr::monotonic_buffer_resource arena(arenaBuffer.data(), arenaBuffer.size());
+            auto nval = S::template deserialize<PmrMap>(data, &arena);
+            doNotOptimize(nval);
+        });
+    }
+#endif
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.rfind("--max-bytes=", 0) == 0)
+        {
+            options.maxBytes = std::stoull(arg.substr(12));
+        }
+        else if (arg.rfind("--min-time=", 0) == 0)
+        {
+            options.minTime = std::stod(arg.substr(11));
+        }
+        else if (arg.rfind("--filter=", 0) == 0)
+        {
+            options.filter = arg.substr(9);
+        }
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--max-bytes=N] [--min-time=SECONDS] [--filter=SUBSTRING]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Bench bench(options);
+    constexpr ByteOrder foreign = Host == BigEndian ? LittleEndian : BigEndian;
+    benchOrder<Serializer<>>(bench, "Host");
+    benchOrder<Serializer<foreign>>(bench, "Foreign");
+    benchOrder<Serializer<Host, void, VarintSize>>(bench, "Host,VarintSize");
+    benchOrder<Serializer<Host, void, Varint>>(bench, "Host,Varint");
+    bench.report(stdout);
+    return 0;
+}
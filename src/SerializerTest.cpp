@@ -7,8 +7,12 @@
 
 #include "Serializer.h"
 
+#include <deque>
 #include <list>
+#include <random>
+#include <sstream>
 #include <unordered_set>
+#include <unistd.h>
 
 enum EnumTestType : uint32_t
 {
@@ -35,6 +39,131 @@ public:
 
 CUSTOM_SERIALIZABLE(TestStruct, v1, v2, v3);
 
+struct CopyCounted
+{
+    static inline size_t copies = 0;
+    std::string value;
+
+    CopyCounted() = default;
+    explicit CopyCounted(std::string value) : value(std::move(value)) {}
+    CopyCounted(const CopyCounted &other) : value(other.value) { ++copies; }
+    CopyCounted(CopyCounted &&other) = default;
+    CopyCounted &operator=(const CopyCounted &other) { value = other.value; ++copies; return *this; }
+    CopyCounted &operator=(CopyCounted &&other) = default;
+    bool operator==(const CopyCounted &other) const { return value == other.value; }
+};
+
+CUSTOM_SERIALIZABLE(CopyCounted, value);
+
+struct Quote
+{
+    uint64_t time;
+    uint64_t id;
+    double price;
+    uint32_t volume;
+    EnumTestType side;
+    char venue[3];
+
+    bool operator==(const Quote &other) const
+    {
+        return time == other.time && id == other.id && price == other.price && volume == other.volume &&
+               side == other.side && std::equal(std::begin(venue), std::end(venue), std::begin(other.venue));
+    }
+};
+
+CUSTOM_SERIALIZABLE(Quote, time, id, price, volume, side, venue);
+
+struct Sample
+{
+    uint64_t time;
+    int32_t value;
+    EnumTestType kind;
+
+    bool operator==(const Sample &other) const
+    {
+        return time == other.time && value == other.value && kind == other.kind;
+    }
+};
+
+CUSTOM_SERIALIZABLE(Sample, time, value, kind);
+
+struct Interval
+{
+    uint32_t begin;
+    uint32_t end;
+
+    bool operator==(const Interval &other) const
+    {
+        return begin == other.begin && end == other.end;
+    }
+};
+
+CUSTOM_SERIALIZABLE(Interval, end, begin);
+
+struct Message
+{
+    uint32_t id;
+    std::vector<std::string> names;
+    std::tuple<int, std::vector<std::vector<int>>> nested;
+    std::string tags[2];
+
+    bool operator==(const Message &other) const
+    {
+        return id == other.id && names == other.names && nested == other.nested &&
+               std::equal(std::begin(tags), std::end(tags), std::begin(other.tags));
+    }
+};
+
+CUSTOM_SERIALIZABLE(Message, id, names, nested, tags);
+
+struct BytePair
+{
+    uint8_t first;
+    uint8_t second;
+
+    bool operator==(const BytePair &other) const
+    {
+        return first == other.first && second == other.second;
+    }
+};
+
+CUSTOM_SERIALIZABLE(BytePair, first, second);
+
+#if defined(__cpp_lib_memory_resource)
+
+struct CountingResource : std::pmr::memory_resource
+{
+    size_t allocations = 0;
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *ptr, size_t bytes, size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+#endif
+
+struct PostingList : std::vector<uint32_t>
+{
+    using std::vector<uint32_t>::vector;
+};
+
+DELTA_PACKED(PostingList);
+DELTA_PACKED(std::set<uint64_t>);
+DELTA_PACKED(std::multiset<int32_t>);
+
 TEST_CASE("Serializer test")
 {
     SECTION("Simple types")
@@ -378,6 +507,938 @@ TEST_CASE("Serializer test")
         REQUIRE(std::equal(std::begin(val4), std::end(val4), std::begin(nval4), std::end(nval4)));
         REQUIRE(val5 == nval5);
     }
+    SECTION("Single pass")
+    {
+        auto val0 = GENERATE(take(1, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max())));
+        auto size = GENERATE(take(1, random(1, 1024)));
+        auto val1 = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+        std::map<std::string, std::vector<TestStruct>> val2 {{"first", {{1, "one", {2, 3}}, {4, "four", {5, 6}}}},
+                                                             {"second", {{7, std::string(size, 'x'), {8, 9}}}}};
+        auto data = Serializer<>::serializeSinglePass(val0, val1, val2);
+        REQUIRE(data == Serializer<>::serialize(val0, val1, val2));
+        decltype(val0) nval0;
+        decltype(val1) nval1;
+        decltype(val2) nval2;
+        Serializer<>::deserialize(data, nval0, nval1, nval2);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+        REQUIRE(nval2.size() == 2);
+        REQUIRE(nval2["second"][0].get2() == std::string(size, 'x'));
+    }
+    SECTION("Append to buffer")
+    {
+        auto size = GENERATE(take(1, random(1, 1024)));
+        auto val0 = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+        std::string val1(size, 'y');
+        auto expected = Serializer<>::serialize(val0, val1);
+        Serialization::Buffer buffer;
+        Serializer<>::appendData(buffer, val0, val1);
+        REQUIRE(std::equal(buffer.begin(), buffer.end(), expected.begin(), expected.end()));
+        auto capacity = buffer.capacity();
+        buffer.clear();
+        Serializer<>::appendData(buffer, val0);
+        Serializer<>::appendData(buffer, val1);
+        REQUIRE(buffer.capacity() == capacity);
+        REQUIRE(std::equal(buffer.begin(), buffer.end(), expected.begin(), expected.end()));
+        std::string str = "prefix";
+        Serializer<>::appendData(str, val0, val1);
+        REQUIRE(str.size() == 6 + expected.size());
+        REQUIRE(std::equal(str.begin() + 6, str.end(), expected.begin(), expected.end()));
+        decltype(val0) nval0;
+        decltype(val1) nval1;
+        Serializer<>::readData(str.data() + 6, str.size() - 6, nval0, nval1);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+    }
+    SECTION("Bounded write")
+    {
+        auto size = GENERATE(take(1, random(1, 1024)));
+        auto val0 = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+        std::vector<std::string> val1 {"first", std::string(size, 'z'), "third"};
+        auto expected = Serializer<>::serialize(val0, val1);
+        std::vector<char> data(expected.size() / 2);
+        REQUIRE(Serializer<>::tryWriteData(data.data(), data.size(), val0, val1) == expected.size());
+        data.resize(expected.size());
+        REQUIRE(Serializer<>::tryWriteData(data.data(), data.size(), val0, val1) == expected.size());
+        REQUIRE(data == expected);
+        REQUIRE(Serializer<>::tryWriteData(nullptr, 0, val0, val1) == expected.size());
+    }
+    SECTION("Views")
+    {
+        auto size = GENERATE(take(1, random(1, 1024)));
+        auto val0 = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+        std::string val1(size, 'v');
+        REQUIRE(Serializer<>::priorityType<std::string_view> == Serializer<>::ArithmeticView);
+        REQUIRE(Serializer<>::priorityType<Serialization::ArrayView<int>> == Serializer<>::ArithmeticView);
+        auto data = Serializer<>::serialize(val0, val1);
+        REQUIRE(Serializer<>::serializeSinglePass(Serialization::ArrayView<int>(val0.data(), val0.size()), std::string_view(val1)) == data);
+        Serialization::ArrayView<int> nval0;
+        std::string_view nval1;
+        Serializer<>::deserialize(data, nval0, nval1);
+        REQUIRE(!nval0.owning());
+        REQUIRE(reinterpret_cast<const char *>(nval0.data()) == data.data() + sizeof(size_t));
+        REQUIRE(std::equal(val0.begin(), val0.end(), nval0.begin(), nval0.end()));
+        REQUIRE(nval1.data() > data.data());
+        REQUIRE(nval1.data() < data.data() + data.size());
+        REQUIRE(nval1 == val1);
+        std::vector<char> shifted(data.size() + 1);
+        memcpy(shifted.data() + 1, data.data(), data.size());
+        Serializer<>::readData(shifted.data() + 1, data.size(), nval0, nval1);
+        REQUIRE(nval0.owning());
+        REQUIRE(std::equal(val0.begin(), val0.end(), nval0.begin(), nval0.end()));
+        REQUIRE(nval1 == val1);
+        auto copy = nval0;
+        REQUIRE(copy.data() != nval0.data());
+        REQUIRE(std::equal(val0.begin(), val0.end(), copy.begin(), copy.end()));
+        std::basic_string_view<char16_t> u16view;
+        std::u16string u16(3, u'x');
+        auto u16data = Serializer<>::serialize(u16);
+        std::vector<char> u16shifted(u16data.size() + 1);
+        memcpy(u16shifted.data() + 1, u16data.data(), u16data.size());
+        REQUIRE_THROWS_AS(Serializer<>::readData(u16shifted.data() + 1, u16data.size(), u16view), Serialization::DeserializationError);
+    }
+    SECTION("Contiguous without value-initialization")
+    {
+        constexpr ByteOrder order = Host == BigEndian ? LittleEndian : BigEndian;
+        auto size = GENERATE(take(1, random(1, 1024)));
+        auto val0 = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+        std::string val1(size, 'c');
+        std::vector<int, Serialization::DefaultInitAllocator<int>> val2(val0.begin(), val0.end());
+        auto data = Serializer<>::serialize(val0, val1, val2);
+        std::vector<int> nval0(size * 2, 1);
+        std::string nval1;
+        decltype(val2) nval2;
+        Serializer<>::deserialize(data, nval0, nval1, nval2);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+        REQUIRE(val2 == nval2);
+        std::vector<char> shifted(data.size() + 1);
+        memcpy(shifted.data() + 1, data.data(), data.size());
+        Serializer<>::readData(shifted.data() + 1, data.size(), nval0, nval1, nval2);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+        REQUIRE(val2 == nval2);
+        auto foreign = Serializer<order>::serialize(val0, val1, val2);
+        Serializer<order>::deserialize(foreign, nval0, nval1, nval2);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+        REQUIRE(val2 == nval2);
+        std::vector<EnumTestType> val3;
+        for (int i = 0; i < size; ++i)
+        {
+            val3.push_back(EnumTestType(i % 4));
+        }
+        decltype(val3) nval3;
+        auto network = Serializer<Network>::serialize(val3);
+        Serializer<Network>::deserialize(network, nval3);
+        REQUIRE(val3 == nval3);
+        shifted.assign(network.size() + 1, 0);
+        memcpy(shifted.data() + 1, network.data(), network.size());
+        Serializer<Network>::readData(shifted.data() + 1, network.size(), nval3);
+        REQUIRE(val3 == nval3);
+        auto length = std::numeric_limits<size_t>::max() / sizeof(int) + 2;
+        std::vector<char> huge(sizeof(length) + sizeof(int) * 2);
+        memcpy(huge.data(), &length, sizeof(length));
+        REQUIRE_THROWS_AS(Serializer<>::readData(huge.data(), huge.size(), nval0), Serialization::DeserializationError);
+    }
+    SECTION("Reserve")
+    {
+        auto size = GENERATE(take(1, random(1000, 10000)));
+        std::unordered_map<int, std::string> val;
+        for (int i = 0; i < size; ++i)
+        {
+            val.emplace(i, std::to_string(i));
+        }
+        decltype(val) nval;
+        Serializer<>::deserialize(Serializer<>::serialize(val), nval);
+        REQUIRE(val == nval);
+        decltype(val) reserved;
+        reserved.reserve(val.size());
+        REQUIRE(nval.bucket_count() == reserved.bucket_count());
+    }
+    SECTION("Move elements")
+    {
+        auto size = GENERATE(take(1, random(1, 1024)));
+        std::map<std::string, CopyCounted> val0;
+        std::unordered_map<std::string, std::vector<CopyCounted>> val1;
+        std::forward_list<CopyCounted> val2;
+        std::list<std::pair<CopyCounted, std::string>> val3;
+        for (int i = 0; i < size; ++i)
+        {
+            auto str = std::to_string(i) + std::string(32, 'k');
+            val0.emplace(str, str);
+            val1[str].emplace_back(str);
+            val2.emplace_front(str);
+            val3.emplace_back(CopyCounted(str), str);
+        }
+        auto data = Serializer<>::serializeSinglePass(val0, val1, val2, val3);
+        decltype(val0) nval0;
+        decltype(val1) nval1;
+        decltype(val2) nval2;
+        decltype(val3) nval3;
+        CopyCounted::copies = 0;
+        Serializer<>::deserialize(data, nval0, nval1, nval2, nval3);
+        REQUIRE(CopyCounted::copies == 0);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+        REQUIRE(val2 == nval2);
+        REQUIRE(val3 == nval3);
+    }
+    SECTION("Streams")
+    {
+        constexpr ByteOrder order = Host == BigEndian ? LittleEndian : BigEndian;
+        auto size = GENERATE(take(1, random(1, 1024)));
+        auto val0 = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+        std::map<std::string, std::vector<TestStruct>> val1 {{"first", {{1, "one", {1, 1}}}}, {std::string(size, 's'), {}}};
+        std::vector<uint32_t> val2(Serialization::streamBufferSize / 2 + size, uint32_t(size));
+        std::string val3(Serialization::streamBufferSize + size, 'b');
+        auto expected = Serializer<>::serialize(val0, val1, val2, val3);
+        std::stringstream stream;
+        Serializer<>::writeStream(stream, val0, val1, val2, val3);
+        REQUIRE(stream.str() == std::string(expected.begin(), expected.end()));
+        decltype(val0) nval0;
+        decltype(val1) nval1;
+        decltype(val2) nval2;
+        decltype(val3) nval3;
+        Serializer<>::readStream(stream, nval0, nval1, nval2, nval3);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1.size() == nval1.size());
+        REQUIRE(val2 == nval2);
+        REQUIRE(val3 == nval3);
+        std::vector<char> data;
+        Serializer<order>::writeCallback([&](const char *ptr, size_t n) { data.insert(data.end(), ptr, ptr + n); },
+                                         val0, val2, val3);
+        REQUIRE(data == Serializer<order>::serialize(val0, val2, val3));
+        size_t pos = 0;
+        auto source = [&](char *ptr, size_t n)
+        {
+            n = std::min(n, std::min(size_t(7), data.size() - pos));
+            memcpy(ptr, data.data() + pos, n);
+            pos += n;
+            return n;
+        };
+        Serializer<order>::readCallback(source, nval0, nval2, nval3);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val2 == nval2);
+        REQUIRE(val3 == nval3);
+        data.resize(data.size() - 1);
+        pos = 0;
+        REQUIRE_THROWS_AS(Serializer<order>::readCallback(source, nval0, nval2, nval3), Serialization::DeserializationError);
+        std::string_view view;
+        Serialization::ArrayView<uint32_t> arrayView;
+        std::stringstream viewStream;
+        Serializer<>::writeStream(viewStream, val3, val2);
+        REQUIRE_THROWS_AS(Serializer<>::readStream(viewStream, view), Serialization::DeserializationError);
+        viewStream.seekg(0);
+        Serializer<>::readStream(viewStream, nval3, arrayView);
+        REQUIRE(arrayView.owning());
+        REQUIRE(std::equal(val2.begin(), val2.end(), arrayView.begin(), arrayView.end()));
+        std::stringstream messages;
+        Serializer<>::writeStream(messages, val0, val1);
+        Serializer<>::writeStream(messages, val3);
+        Serializer<>::readStream(messages, nval0, nval1);
+        nval3.clear();
+        Serializer<>::readStream(messages, nval3);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1.size() == nval1.size());
+        REQUIRE(val3 == nval3);
+        REQUIRE(messages.peek() == std::stringstream::traits_type::eof());
+        //Corrupted element count is not trusted by containers read from a stream
+        size_t corruptedCount = size_t(1) << 40;
+        std::string element = "element";
+        std::stringstream corrupted;
+        Serializer<>::writeStream(corrupted, corruptedCount, element);
+        std::vector<std::string> nstrings;
+        REQUIRE_THROWS_AS(Serializer<>::readStream(corrupted, nstrings), Serialization::DeserializationError);
+        std::stringstream corruptedCompressed;
+        Serializer<>::writeCompressedStream(corruptedCompressed, corruptedCount, element);
+        REQUIRE_THROWS_AS(Serializer<>::readCompressedStream(corruptedCompressed, nstrings),
+                          Serialization::DeserializationError);
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        Serializer<>::writeDescriptor(fds[1], val0, val1);
+        Serializer<>::writeDescriptor(fds[1], size);
+        Serializer<>::writeDescriptor(fds[1], val1);
+        Serializer<>::writeDescriptor(fds[1], size);
+        close(fds[1]);
+        decltype(size) nsize = 0;
+        {
+            Serializer<>::StreamReader<Serialization::DescriptorSource> reader(Serialization::DescriptorSource {fds[0]});
+            reader.read(nval0, nval1);
+            reader.read(nsize);
+            REQUIRE(val0 == nval0);
+            REQUIRE(val1.size() == nval1.size());
+            REQUIRE(size == nsize);
+        }
+        REQUIRE_THROWS_AS(Serializer<>::readDescriptor(fds[0], nsize), Serialization::DeserializationError);
+        close(fds[0]);
+        REQUIRE(pipe(fds) == 0);
+        Serializer<>::writeDescriptor(fds[1], val1);
+        Serializer<>::writeDescriptor(fds[1], size);
+        close(fds[1]);
+        nval1.clear();
+        nsize = 0;
+        Serializer<>::readDescriptorExact(fds[0], nval1);
+        Serializer<>::readDescriptorExact(fds[0], nsize);
+        close(fds[0]);
+        REQUIRE(val1.size() == nval1.size());
+        REQUIRE(size == nsize);
+        char path[] = "/tmp/SerializerTestXXXXXX";
+        int fd = mkstemp(path);
+        REQUIRE(fd >= 0);
+        unlink(path);
+        Serializer<>::writeDescriptor(fd, val0);
+        Serializer<>::writeDescriptor(fd, val3);
+        REQUIRE(lseek(fd, 0, SEEK_SET) == 0);
+        Serializer<>::readDescriptor(fd, nval0);
+        nval3.clear();
+        Serializer<>::readDescriptor(fd, nval3);
+        REQUIRE(lseek(fd, 0, SEEK_CUR) == off_t(Serializer<>::byteSize(val0, val3)));
+        close(fd);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val3 == nval3);
+    }
+    SECTION("Mapped file")
+    {
+        auto size = GENERATE(take(1, random(1, 1024)));
+        auto val0 = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+        std::string val1(size, 'm');
+        char path[] = "/tmp/SerializerTestXXXXXX";
+        int fd = mkstemp(path);
+        REQUIRE(fd >= 0);
+        Serializer<>::writeDescriptor(fd, val0, val1);
+        close(fd);
+        Serialization::ArrayView<int> nval0;
+        std::string_view nval1;
+        {
+            auto file = Serializer<>::readFile(path, nval0, nval1);
+            REQUIRE(file.size() == Serializer<>::byteSize(val0, val1));
+            REQUIRE(!nval0.owning());
+            REQUIRE(reinterpret_cast<const char *>(nval0.data()) == file.data() + sizeof(size_t));
+            REQUIRE(std::equal(val0.begin(), val0.end(), nval0.begin(), nval0.end()));
+            REQUIRE(nval1 == val1);
+            auto moved = std::move(file);
+            REQUIRE(file.data() == nullptr);
+            REQUIRE(nval1 == val1);
+        }
+        truncate(path, 0);
+        REQUIRE_THROWS_AS(Serializer<>::readFile(path, nval0), Serialization::DeserializationError);
+        unlink(path);
+        REQUIRE_THROWS_AS(Serializer<>::readFile(path, nval0), std::system_error);
+    }
+    SECTION("Gather")
+    {
+        constexpr ByteOrder order = Host == BigEndian ? LittleEndian : BigEndian;
+        auto size = GENERATE(take(1, random(1, 1 << 16)));
+        std::string val0(Serialization::gatherThreshold + size_t(size), 'g');
+        std::vector<uint32_t> val1(static_cast<size_t>(size));
+        for (size_t i = 0; i < val1.size(); ++i)
+        {
+            val1[i] = uint32_t(i);
+        }
+        std::vector<std::string> val2 {"small", val0, ""};
+        auto data = Serializer<>::serialize(val0, val1, val2);
+        Serialization::GatherOutput out;
+        Serializer<>::appendGather(out, val0, val1, val2);
+        REQUIRE(out.size() == data.size());
+        REQUIRE(out.referencedSize() >= 2 * val0.size());
+        std::string gathered;
+        bool inPlace = false;
+        for (auto &i : out.segments())
+        {
+            inPlace |= i.iov_base == val0.data();
+            gathered.append(static_cast<const char *>(i.iov_base), i.iov_len);
+        }
+        REQUIRE(inPlace);
+        REQUIRE(std::vector<char>(gathered.begin(), gathered.end()) == data);
+        Serialization::GatherOutput foreignOut(1);
+        Serializer<order>::appendGather(foreignOut, val1);
+        REQUIRE(foreignOut.referencedSize() == 0);
+        REQUIRE(foreignOut.segments().size() == 1);
+        char path[] = "/tmp/SerializerTestXXXXXX";
+        int fd = mkstemp(path);
+        REQUIRE(fd >= 0);
+        Serializer<>::writeGather(fd, val0, val1, val2);
+        close(fd);
+        decltype(val0) nval0;
+        decltype(val1) nval1;
+        decltype(val2) nval2;
+        Serializer<>::readFile(path, nval0, nval1, nval2);
+        unlink(path);
+        REQUIRE(nval0 == val0);
+        REQUIRE(nval1 == val1);
+        REQUIRE(nval2 == val2);
+    }
+    SECTION("Segments")
+    {
+        typedef Serializer<Host, void, Varint> VarintSerializer;
+        auto size = GENERATE(take(1, random(1, 1024)));
+        auto val0 = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+        std::string val1(size_t(size) * 4, 's');
+        std::map<std::string, std::vector<int>> val2 {{"key", val0}, {std::string(100, 'k'), {}}};
+        auto data = VarintSerializer::serialize(val0, val1, val2);
+        //Cut data into segments of random sizes, including empty ones
+        std::mt19937 rng(static_cast<uint32_t>(size));
+        std::vector<std::string_view> segments;
+        for (size_t pos = 0; pos < data.size();)
+        {
+            auto length = std::min<size_t>(rng() % 64, data.size() - pos);
+            segments.emplace_back(data.data() + pos, length);
+            pos += length;
+        }
+        decltype(val0) nval0;
+        decltype(val1) nval1;
+        decltype(val2) nval2;
+        VarintSerializer::readSegments(segments, nval0, nval1, nval2);
+        REQUIRE(nval0 == val0);
+        REQUIRE(nval1 == val1);
+        REQUIRE(nval2 == val2);
+        segments.back().remove_suffix(1);
+        REQUIRE_THROWS_AS(VarintSerializer::readSegments(segments, nval0, nval1, nval2),
+                          Serialization::DeserializationError);
+        auto data1 = Serializer<>::serialize(val1, val0);
+        std::vector<std::string_view> segments1 {{data1.data(), 5}, {data1.data() + 5, data1.size() - 5}};
+        std::string_view nval3;
+        Serialization::ArrayView<int> nval4;
+        Serializer<>::readSegments(segments1, nval3, nval4);
+        REQUIRE(nval3 == val1);
+        REQUIRE(!nval4.owning());
+        REQUIRE(std::equal(val0.begin(), val0.end(), nval4.begin(), nval4.end()));
+        segments1 = {{data1.data(), sizeof(size_t) + 1}, {data1.data() + sizeof(size_t) + 1, data1.size() - sizeof(size_t) - 1}};
+        REQUIRE_THROWS_AS(Serializer<>::readSegments(segments1, nval3), Serialization::DeserializationError);
+        Serialization::GatherOutput out;
+        Serializer<>::appendGather(out, val1, val0, val2);
+        REQUIRE(Serializer<>::readSegments<decltype(val1)>(out.segments()) == val1);
+    }
+    SECTION("Incremental")
+    {
+        auto size = GENERATE(take(1, random(1, 1024)));
+        auto val0 = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+        std::map<std::string, std::vector<int>> val1 {{"key", val0}, {std::string(100, 'k'), {}}, {"", {1, 2}}};
+        std::pair<std::string, std::vector<int>> val2 {std::string(size_t(size), 's'), val0};
+        auto data = Serializer<>::serialize(val1, val2);
+        //Feed data in pieces of random sizes, including empty ones, the rest of a piece belongs to the next value
+        std::mt19937 rng(static_cast<uint32_t>(size));
+        Serializer<>::IncrementalReader<decltype(val1)> reader1;
+        Serializer<>::IncrementalReader<decltype(val2)> reader2;
+        for (size_t pos = 0; pos < data.size();)
+        {
+            auto length = std::min<size_t>(rng() % 64, data.size() - pos);
+            auto used = reader1.done() ? 0 : reader1.feed(data.data() + pos, length);
+            REQUIRE(reader1.done() == (reader1.needed() == 0));
+            REQUIRE(reader1.feed(data.data() + pos + used, length - used) == 0);
+            reader2.feed(data.data() + pos + used, length - used);
+            REQUIRE((reader2.done() || pos + length < data.size()));
+            pos += length;
+        }
+        REQUIRE(reader1.value() == val1);
+        REQUIRE(reader2.value() == val2);
+        REQUIRE(reader2.needed() == 0);
+        reader1.reset();
+        REQUIRE(!reader1.done());
+        REQUIRE(reader1.feed(data.data(), data.size()) == Serializer<>::byteSize(val1));
+        REQUIRE(reader1.value() == val1);
+        //Only the size prefix is received, the rest of a string is known to be needed
+        Serializer<>::IncrementalReader<std::string> reader3;
+        reader3.feed(data.data() + Serializer<>::byteSize(val1), sizeof(size_t));
+        REQUIRE(reader3.needed() == val2.first.size());
+        reader3.feed(val2.first.data(), val2.first.size());
+        REQUIRE(reader3.value() == val2.first);
+        typedef Serializer<Host, void, Varint> VarintSerializer;
+        //Packed integers are decoded to find their end
+        auto packed = VarintSerializer::serialize(val0);
+        VarintSerializer::IncrementalReader<decltype(val0)> reader4;
+        for (size_t pos = 0; pos < packed.size(); ++pos)
+        {
+            REQUIRE(!reader4.done());
+            reader4.feed(packed.data() + pos, 1);
+        }
+        REQUIRE(reader4.value() == val0);
+        VarintSerializer::IncrementalReader<std::list<int64_t>> reader5;
+        std::string malformed(1 + 11, char(0xFF));
+        malformed[0] = 1;
+        reader5.feed(malformed.data(), 5);
+        REQUIRE(reader5.needed() == 1);
+        REQUIRE_THROWS_AS(reader5.feed(malformed.data() + 5, malformed.size() - 5), Serialization::DeserializationError);
+        //Fields of a structure and elements of it's nested containers are decoded as soon as they are received
+        Message message {uint32_t(size), {"first", std::string(size_t(size), 'n'), ""},
+                         {size, {val0, {}, {1, 2, 3}}}, {"tag", std::string(size_t(size), 't')}};
+        auto messageData = Serializer<>::serialize(message);
+        Serializer<>::IncrementalReader<Message> reader6;
+        for (size_t pos = 0; pos < messageData.size(); ++pos)
+        {
+            REQUIRE(!reader6.done());
+            REQUIRE(reader6.feed(messageData.data() + pos, 1) == 1);
+            if (pos + 1 == Serializer<>::byteSize(message.id, message.names))
+            {
+                REQUIRE(reader6.value().id == message.id);
+                REQUIRE(reader6.value().names == message.names);
+                REQUIRE(std::get<1>(reader6.value().nested).empty());
+            }
+        }
+        REQUIRE(reader6.done());
+        REQUIRE(reader6.value() == message);
+    }
+    SECTION("Variable length integers")
+    {
+        typedef Serializer<Host, void, VarintSize> SizeSerializer;
+        typedef Serializer<Host, void, Varint> VarintSerializer;
+        auto size = GENERATE(take(1, random(1, 1024)));
+        auto val0 = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+        std::vector<std::string> val1 {"", "a", std::string(127, 'b'), std::string(128, 'c'), std::string(size, 'd')};
+        std::list<int64_t> val2 {0, -1, 1, 63, -64, 64, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()};
+        std::tuple<uint16_t, uint64_t, EnumTestType, bool, double> val3 {uint16_t(size), std::numeric_limits<uint64_t>::max(), Three, true, 0.5};
+        REQUIRE(SizeSerializer::serialize(val1[1]).size() == 2);
+        REQUIRE(SizeSerializer::serialize(val1[2]).size() == 128);
+        REQUIRE(SizeSerializer::serialize(val1[3]).size() == 130);
+        REQUIRE(SizeSerializer::serialize(val2).size() == 1 + val2.size() * sizeof(int64_t));
+        REQUIRE(VarintSerializer::serialize(val2).size() == 1 + 1 + 1 + 1 + 1 + 1 + 2 + 10 + 10);
+        REQUIRE(VarintSerializer::serialize(val3).size() == (size < 128 ? 1 : 2) + 10 + 1 + 1 + sizeof(double));
+        auto sizeData = SizeSerializer::serialize(val0, val1, val2, val3);
+        REQUIRE(sizeData.size() == SizeSerializer::byteSize(val0, val1, val2, val3));
+        REQUIRE(SizeSerializer::serializeSinglePass(val0, val1, val2, val3) == sizeData);
+        decltype(val0) nval0;
+        decltype(val1) nval1;
+        decltype(val2) nval2;
+        decltype(val3) nval3;
+        SizeSerializer::deserialize(sizeData, nval0, nval1, nval2, nval3);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+        REQUIRE(val2 == nval2);
+        REQUIRE(val3 == nval3);
+        auto data = VarintSerializer::serialize(val0, val1, val2, val3);
+        REQUIRE(data.size() == VarintSerializer::byteSize(val0, val1, val2, val3));
+        REQUIRE(VarintSerializer::byteSize(val1, val2, val3) < SizeSerializer::byteSize(val1, val2, val3));
+        VarintSerializer::deserialize(data, nval0, nval1, nval2, nval3);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+        REQUIRE(val2 == nval2);
+        REQUIRE(val3 == nval3);
+        size_t pos = 0;
+        VarintSerializer::readCallback([&](char *ptr, size_t n)
+                                       {
+                                           n = std::min(n, std::min(size_t(3), data.size() - pos));
+                                           memcpy(ptr, data.data() + pos, n);
+                                           pos += n;
+                                           return n;
+                                       }, nval0, nval1, nval2, nval3);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+        REQUIRE(val2 == nval2);
+        REQUIRE(val3 == nval3);
+        REQUIRE_THROWS_AS(VarintSerializer::readData(data.data(), data.size() - 1, nval0, nval1, nval2, nval3),
+                          Serialization::DeserializationError);
+        std::vector<char> malformed(11, char(0xFF));
+        REQUIRE_THROWS_AS(VarintSerializer::deserialize<uint64_t>(malformed), Serialization::DeserializationError);
+        REQUIRE_THROWS_AS(VarintSerializer::deserialize<uint16_t>(VarintSerializer::serialize(std::get<1>(val3))),
+                          Serialization::DeserializationError);
+        std::vector<char> truncated {char(0x80), char(0x01), 'a'};
+        REQUIRE_THROWS_AS(SizeSerializer::deserialize<std::string>(truncated), Serialization::DeserializationError);
+    }
+    SECTION("Packed integers")
+    {
+        typedef Serializer<Host, void, Varint> VarintSerializer;
+        auto size = GENERATE(take(1, random(1, 5000)));
+        auto val0 = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+        std::vector<uint32_t> val1(size);
+        std::vector<int64_t> val2(size);
+        std::vector<uint64_t> val3(size);
+        std::vector<uint16_t> val4(size);
+        std::vector<int16_t> val5(size);
+        for (size_t i = 0; i < val1.size(); ++i)
+        {
+            val1[i] = uint32_t(i) << (i % 4 * 8);
+            val2[i] = int64_t(i) * (i % 2 ? -1 : 1);
+            val3[i] = uint64_t(val0[i]) << (i % 5 * 8);
+            val4[i] = uint16_t(i % 3 ? i % 256 : val0[i]);
+            val5[i] = int16_t(val0[i] % 64);
+        }
+        REQUIRE(VarintSerializer::priorityType<decltype(val0)> == VarintSerializer::PackedContiguous);
+        REQUIRE(VarintSerializer::priorityType<Serialization::ArrayView<uint64_t>> == VarintSerializer::PackedContiguous);
+        REQUIRE(VarintSerializer::priorityType<std::u32string> == VarintSerializer::ArithmeticContiguous);
+        REQUIRE(VarintSerializer::priorityType<std::u16string> == VarintSerializer::ArithmeticContiguous);
+        REQUIRE(VarintSerializer::priorityType<decltype(val4)> == VarintSerializer::PackedContiguous);
+        REQUIRE(VarintSerializer::priorityType<std::vector<uint8_t>> == VarintSerializer::ArithmeticContiguous);
+        auto data = VarintSerializer::serialize(val0, val1, val2, val3, val4, val5);
+        REQUIRE(data.size() == VarintSerializer::byteSize(val0, val1, val2, val3, val4, val5));
+        REQUIRE(VarintSerializer::serializeSinglePass(val0, val1, val2, val3, val4, val5) == data);
+        REQUIRE(VarintSerializer::byteSize(val2) < Serializer<>::byteSize(val2) / 2);
+        //16 bit values below 256 take a byte and a quarter of a control byte
+        REQUIRE(VarintSerializer::byteSize(val5) < Serializer<>::byteSize(val5) * 3 / 4);
+        decltype(val0) nval0;
+        decltype(val1) nval1;
+        decltype(val2) nval2(size * 2, 1);
+        Serialization::ArrayView<uint64_t> nval3;
+        decltype(val4) nval4;
+        decltype(val5) nval5;
+        VarintSerializer::deserialize(data, nval0, nval1, nval2, nval3, nval4, nval5);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+        REQUIRE(val2 == nval2);
+        REQUIRE(std::equal(val3.begin(), val3.end(), nval3.begin(), nval3.end()));
+        REQUIRE(val4 == nval4);
+        REQUIRE(val5 == nval5);
+        size_t pos = 0;
+        VarintSerializer::readCallback([&](char *ptr, size_t n)
+                                       {
+                                           n = std::min(n, std::min(size_t(13), data.size() - pos));
+                                           memcpy(ptr, data.data() + pos, n);
+                                           pos += n;
+                                           return n;
+                                       }, nval0, nval1, nval2, nval3, nval4, nval5);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+        REQUIRE(val2 == nval2);
+        REQUIRE(std::equal(val3.begin(), val3.end(), nval3.begin(), nval3.end()));
+        REQUIRE(val4 == nval4);
+        REQUIRE(val5 == nval5);
+        REQUIRE_THROWS_AS(VarintSerializer::readData(data.data(), data.size() - 1, nval0, nval1, nval2, nval3,
+                                                     nval4, nval5),
+                          Serialization::DeserializationError);
+    }
+    SECTION("Delta packed integers")
+    {
+        auto size = GENERATE(take(1, random(1, 5000)));
+        auto step = GENERATE(take(1, random(1, 100000)));
+        PostingList val0(size);
+        std::set<uint64_t> val1;
+        std::multiset<int32_t> val2;
+        for (size_t i = 0; i < val0.size(); ++i)
+        {
+            val0[i] = uint32_t(i * (i % 7) + i * size_t(step));
+            val1.insert(uint64_t(i) * uint64_t(step) * (i % 3 ? 1 : uint64_t(1) << 32));
+        }
+        for (size_t i = 0; i < 4096; ++i)
+        {
+            val2.insert(int32_t(i % 100) - 50);
+        }
+        std::vector<uint32_t> unsorted(val0.rbegin(), val0.rend());
+        PostingList val3(unsorted.begin(), unsorted.end());
+        REQUIRE(Serializer<>::priorityType<PostingList> == Serializer<>::DeltaPacked);
+        REQUIRE(Serializer<>::priorityType<std::vector<uint32_t>> == Serializer<>::ArithmeticContiguous);
+        auto data = Serializer<>::serialize(val0, val1, val2, val3);
+        REQUIRE(data.size() == Serializer<>::byteSize(val0, val1, val2, val3));
+        REQUIRE(Serializer<>::serializeSinglePass(val0, val1, val2, val3) == data);
+        REQUIRE(Serializer<>::byteSize(val2) * 4 < Serializer<>::byteSize(std::vector<int32_t>(val2.begin(), val2.end())));
+        PostingList nval0;
+        std::set<uint64_t> nval1;
+        std::multiset<int32_t> nval2;
+        PostingList nval3;
+        Serializer<>::deserialize(data, nval0, nval1, nval2, nval3);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+        REQUIRE(val2 == nval2);
+        REQUIRE(val3 == nval3);
+        typedef Serializer<Host, void, Varint> VarintSerializer;
+        auto varintData = VarintSerializer::serialize(val0, val1, val2, val3);
+        nval1.clear();
+        nval2.clear();
+        size_t pos = 0;
+        VarintSerializer::readCallback([&](char *ptr, size_t n)
+                                       {
+                                           n = std::min(n, std::min(size_t(5), varintData.size() - pos));
+                                           memcpy(ptr, varintData.data() + pos, n);
+                                           pos += n;
+                                           return n;
+                                       }, nval0, nval1, nval2, nval3);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1 == nval1);
+        REQUIRE(val2 == nval2);
+        REQUIRE(val3 == nval3);
+        REQUIRE_THROWS_AS(Serializer<>::readData(data.data(), data.size() - 1, nval0, nval1, nval2, nval3),
+                          Serialization::DeserializationError);
+    }
+    SECTION("Compression")
+    {
+        auto size = GENERATE(take(1, random(1, 1024)));
+        auto val0 = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+        std::map<std::string, std::vector<TestStruct>> val1 {{"first", {{1, "one", {1, 1}}}}, {std::string(size, 's'), {}}};
+        std::vector<uint32_t> val2(Serialization::compressedBlockSize + size);
+        for (size_t i = 0; i < val2.size(); ++i)
+        {
+            val2[i] = uint32_t(i % 1000);
+        }
+        std::string val3(Serialization::compressedBlockSize * 2 + size, 'b');
+        auto data = Serializer<>::serialize(val0, val1, val2, val3);
+        auto compressed = Serializer<>::serializeCompressed(val0, val1, val2, val3);
+        REQUIRE(compressed.size() * 10 < data.size());
+        decltype(val0) nval0;
+        decltype(val1) nval1;
+        decltype(val2) nval2;
+        decltype(val3) nval3;
+        Serializer<>::readCompressedData(compressed.data(), compressed.size(), nval0, nval1, nval2, nval3);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val1.size() == nval1.size());
+        REQUIRE(val2 == nval2);
+        REQUIRE(val3 == nval3);
+        REQUIRE(Serializer<>::deserializeCompressed<decltype(val0)>(Serializer<>::serializeCompressed(val0)) == val0);
+        std::stringstream stream;
+        Serializer<>::writeCompressedStream(stream, val0, val1, val2, val3);
+        REQUIRE(stream.str() == std::string(compressed.begin(), compressed.end()));
+        size_t pos = 0;
+        auto source = [&](char *ptr, size_t n)
+        {
+            n = std::min(n, std::min(size_t(7), compressed.size() - pos));
+            memcpy(ptr, compressed.data() + pos, n);
+            pos += n;
+            return n;
+        };
+        nval2.clear();
+        nval3.clear();
+        Serializer<>::readCompressedCallback(source, nval0, nval1, nval2, nval3);
+        REQUIRE(val0 == nval0);
+        REQUIRE(val2 == nval2);
+        REQUIRE(val3 == nval3);
+        //Data which doesn't compress is stored as is
+        auto incompressible = Serializer<>::serializeCompressed(val0);
+        REQUIRE(incompressible.size() <= Serialization::BlockCodec::headerSize + Serializer<>::byteSize(val0));
+        for (auto i : {size_t(0), Serialization::BlockCodec::headerSize - 1})
+        {
+            auto corrupted = compressed;
+            corrupted[i] = char(~corrupted[i]);
+            REQUIRE_THROWS_AS(Serializer<>::readCompressedData(corrupted.data(), corrupted.size(), nval0, nval1, nval2, nval3),
+                              Serialization::DeserializationError);
+        }
+        REQUIRE_THROWS_AS(Serializer<>::readCompressedData(compressed.data(), compressed.size() - 1, nval0, nval1, nval2, nval3),
+                          Serialization::DeserializationError);
+    }
+    SECTION("Parallel")
+    {
+        auto size = GENERATE(take(1, random(1, 100000)));
+        std::vector<TestStruct> val0;
+        for (int i = 0; i < size; ++i)
+        {
+            val0.emplace_back(i, std::string(size_t(i % 17), 'p'), std::pair<long, int> {i, -i});
+        }
+        std::deque<std::string> val1(size_t(size), "deque");
+        std::map<int, int> val2 {{1, 2}, {3, 4}};
+        for (size_t threads : {0, 1, 2, 3, 8})
+        {
+            REQUIRE(Serializer<>::serializeParallel(val0, threads) == Serializer<>::serialize(val0));
+            REQUIRE(Serializer<Network, void, Varint>::serializeParallel(val1, threads) ==
+                    Serializer<Network, void, Varint>::serialize(val1));
+            REQUIRE(Serializer<>::serializeParallel(val2, threads) == Serializer<>::serialize(val2));
+        }
+        Serialization::Buffer buffer(3, 'b');
+        Serializer<>::appendDataParallel(buffer, val0, 4);
+        REQUIRE(std::string(buffer.begin(), buffer.begin() + 3) == "bbb");
+        decltype(val0) nval0;
+        Serializer<>::readData(buffer.data() + 3, buffer.size() - 3, nval0);
+        REQUIRE(nval0.size() == val0.size());
+        REQUIRE(nval0.back().get2() == val0.back().get2());
+    }
+    SECTION("Indexed")
+    {
+        auto size = GENERATE(take(1, random(1, 100000)));
+        std::vector<TestStruct> val0;
+        for (int i = 0; i < size; ++i)
+        {
+            val0.emplace_back(i, std::string(size_t(i % 17), 'i'), std::pair<long, int> {i, -i});
+        }
+        std::map<int, std::string> val1 {{1, "one"}, {2, "two"}};
+        typedef Serializer<Network, void, Varint> VarintSerializer;
+        auto data = Serializer<>::serializeIndexed(val0, 3);
+        auto plain = Serializer<>::serialize(val0);
+        REQUIRE(std::equal(plain.begin(), plain.end(), data.begin()));
+        for (size_t threads : {0, 1, 4})
+        {
+            std::vector<TestStruct> nval0(3);
+            Serializer<>::readDataIndexed(data.data(), data.size(), nval0, threads);
+            REQUIRE(nval0.size() == val0.size());
+            REQUIRE(nval0.back().get1() == val0.back().get1());
+            REQUIRE(nval0.back().get2() == val0.back().get2());
+            std::deque<TestStruct> nval1;
+            auto varintData = VarintSerializer::serializeIndexed(val0, threads);
+            VarintSerializer::readDataIndexed(varintData.data(), varintData.size(), nval1, threads);
+            REQUIRE(nval1.size() == val0.size());
+            REQUIRE(nval1.front().get3() == val0.front().get3());
+            REQUIRE(nval1.back().get3() == val0.back().get3());
+        }
+        auto mapData = Serializer<>::serializeIndexed(val1);
+        decltype(val1) nval1;
+        Serializer<>::readDataIndexed(mapData.data(), mapData.size(), nval1);
+        REQUIRE(val1 == nval1);
+        std::vector<TestStruct> nval0;
+        REQUIRE_THROWS_AS(Serializer<>::readDataIndexed(plain.data(), plain.size(), nval0),
+                          Serialization::DeserializationError);
+        auto corrupted = data;
+        corrupted[plain.size()] = char(~corrupted[plain.size()]);
+        REQUIRE_THROWS_AS(Serializer<>::readDataIndexed(corrupted.data(), corrupted.size(), nval0),
+                          Serialization::DeserializationError);
+    }
+    SECTION("Lazy reader")
+    {
+        auto size = GENERATE(take(1, random(1, 1000)));
+        std::vector<TestStruct> val0;
+        std::map<std::string, std::vector<int>> val1;
+        std::unordered_map<int, std::string> val2;
+        std::vector<std::pair<int, double>> val3;
+        for (int i = 0; i < size; ++i)
+        {
+            val0.emplace_back(i, std::string(size_t(i % 17), 'l'), std::pair<long, int> {i, -i});
+            val1[std::to_string(i)] = std::vector<int>(size_t(i % 5), i);
+            val2[i] = std::to_string(i);
+            val3.emplace_back(i, i / 2.0);
+        }
+        auto data = Serializer<>::serialize(val0, val1, val2, val3);
+        Serializer<>::LazyReader<decltype(val0)> reader0(data.data(), data.size());
+        REQUIRE(reader0.size() == val0.size());
+        auto last = reader0.at(val0.size() - 1);
+        REQUIRE(last.get1() == val0.back().get1());
+        REQUIRE(last.get2() == val0.back().get2());
+        REQUIRE(reader0[0].get3() == val0.front().get3());
+        REQUIRE_THROWS_AS(reader0.at(val0.size()), std::out_of_range);
+        auto offset = Serializer<>::byteSize(val0);
+        Serializer<>::LazyReader<decltype(val1)> reader1(data.data() + offset, data.size() - offset);
+        REQUIRE(reader1.find("0") == val1["0"]);
+        REQUIRE(reader1.find(std::to_string(size - 1)) == val1[std::to_string(size - 1)]);
+        REQUIRE(!reader1.find("-1"));
+        REQUIRE(reader1.at(0).first == val1.begin()->first);
+        offset += Serializer<>::byteSize(val1);
+        Serializer<>::LazyReader<decltype(val2)> reader2(data.data() + offset, data.size() - offset);
+        REQUIRE(reader2.find(size / 2) == val2[size / 2]);
+        REQUIRE(!reader2.find(size));
+        offset += Serializer<>::byteSize(val2);
+        Serializer<>::LazyReader<decltype(val3)> reader3(data.data() + offset, data.size() - offset);
+        REQUIRE(reader3.at(size_t(size - 1)) == val3.back());
+        auto varintData = Serializer<Host, void, Varint>::serialize(val1, val0);
+        Serializer<Host, void, Varint>::LazyReader<decltype(val1)> varintReader(varintData.data(), varintData.size());
+        REQUIRE(varintReader.find(std::to_string(size / 3)) == val1[std::to_string(size / 3)]);
+        REQUIRE_THROWS_AS(Serializer<>::LazyReader<decltype(val0)>(data.data(), 4), Serialization::DeserializationError);
+        Serializer<>::LazyReader<decltype(val0)> truncated(data.data(), Serializer<>::byteSize(val0) - 1);
+        REQUIRE_THROWS_AS(truncated.at(val0.size() - 1), Serialization::DeserializationError);
+    }
+    SECTION("Fixed size")
+    {
+        constexpr ByteOrder order = Host == BigEndian ? LittleEndian : BigEndian;
+        typedef Serializer<Host, void, Varint> VarintSerializer;
+        REQUIRE(Serializer<>::isFixedSize<int>);
+        REQUIRE(Serializer<>::isFixedSize<EnumTestType>);
+        REQUIRE(Serializer<>::isFixedSize<std::array<short, 3>>);
+        REQUIRE(Serializer<>::isFixedSize<std::pair<int, double>[2]>);
+        REQUIRE(!Serializer<>::isFixedSize<TestStruct>);
+        REQUIRE(!Serializer<>::isFixedSize<std::vector<int>>);
+        REQUIRE(Serializer<>::fixedByteSize<Quote> == 2 * sizeof(uint64_t) + sizeof(double) + sizeof(uint32_t) +
+                                                      sizeof(EnumTestType) + sizeof(char[3]));
+        REQUIRE(Serializer<>::fixedByteSize<std::tuple<char, Quote>> == 1 + Serializer<>::fixedByteSize<Quote>);
+        REQUIRE(Serializer<>::fixedByteSize<std::string> == 0);
+        REQUIRE(!VarintSerializer::isFixedSize<Quote>);
+        REQUIRE(VarintSerializer::isFixedSize<std::pair<double, char>>);
+        auto size = GENERATE(take(1, random(1, 1000)));
+        std::vector<Quote> val;
+        for (int i = 0; i < size; ++i)
+        {
+            val.push_back({uint64_t(i) << 20, uint64_t(i), i * 0.5, uint32_t(i), EnumTestType(i % 4), {'a', char(i), 'c'}});
+        }
+        REQUIRE(Serializer<>::byteSize(val) == sizeof(size_t) + val.size() * Serializer<>::fixedByteSize<Quote>);
+        auto data = Serializer<order>::serialize(val);
+        REQUIRE(data.size() == Serializer<order>::byteSize(val));
+        REQUIRE(Serializer<order>::serializeSinglePass(val) == data);
+        REQUIRE(Serializer<order>::deserialize<decltype(val)>(data) == val);
+        std::vector<std::tuple<Quote, char>> val1;
+        for (auto &i : val)
+        {
+            val1.emplace_back(i, char(i.volume));
+        }
+        decltype(val1) nval1;
+        std::stringstream stream;
+        Serializer<order>::writeStream(stream, val1);
+        Serializer<order>::readStream(stream, nval1);
+        REQUIRE(nval1 == val1);
+        REQUIRE_THROWS_AS(Serializer<order>::readData<Quote>(data.data() + sizeof(size_t), Serializer<>::fixedByteSize<Quote> - 1),
+                          Serialization::DeserializationError);
+    }
+    SECTION("Bytewise")
+    {
+        constexpr ByteOrder order = Host == BigEndian ? LittleEndian : BigEndian;
+        REQUIRE(Serializer<>::isBytewise<Sample>);
+        REQUIRE(Serializer<>::isBytewise<std::array<Sample, 2>[3]>);
+        REQUIRE(!Serializer<>::isBytewise<Quote>);
+        REQUIRE(!Serializer<>::isBytewise<Interval>);
+        REQUIRE(!Serializer<>::isBytewise<std::pair<int, int>>);
+        REQUIRE(!Serializer<order>::isBytewise<Sample>);
+        REQUIRE(!Serializer<Host, void, Varint>::isBytewise<Sample>);
+        REQUIRE(Serializer<>::priorityType<std::vector<Sample>> == Serializer<>::ArithmeticContiguous);
+        REQUIRE(Serializer<>::priorityType<Sample[4]> == Serializer<>::ArithmeticArray);
+        REQUIRE(Serializer<>::priorityType<std::array<Sample, 4>> == Serializer<>::Optimized);
+        REQUIRE(Serializer<>::priorityType<std::vector<Interval>> == Serializer<>::Iterable);
+        REQUIRE(Serializer<order>::priorityType<std::vector<Sample>> == Serializer<order>::Iterable);
+        auto size = GENERATE(take(1, random(1, 1000)));
+        std::vector<Sample> val;
+        std::vector<std::tuple<uint64_t, int32_t, EnumTestType>> fields;
+        std::vector<Interval> intervals;
+        std::vector<std::pair<uint32_t, uint32_t>> intervalFields;
+        for (int i = 0; i < size; ++i)
+        {
+            val.push_back({uint64_t(i) << 40 | uint64_t(i), -i, EnumTestType(i % 4)});
+            fields.emplace_back(val.back().time, val.back().value, val.back().kind);
+            intervals.push_back({uint32_t(i), uint32_t(i) * 3});
+            intervalFields.emplace_back(uint32_t(i) * 3, uint32_t(i));
+        }
+        auto data = Serializer<>::serialize(val);
+        REQUIRE(data == Serializer<>::serialize(fields));
+        REQUIRE(data.size() == Serializer<>::byteSize(val));
+        REQUIRE(Serializer<>::deserialize<decltype(val)>(data) == val);
+        REQUIRE(Serializer<>::serialize(intervals) == Serializer<>::serialize(intervalFields));
+        REQUIRE(Serializer<order>::deserialize<decltype(val)>(Serializer<order>::serialize(val)) == val);
+        std::array<Sample, 3> val1 = {val[0], val[size / 2], val[size - 1]};
+        decltype(val1) nval1;
+        decltype(val) nval;
+        std::stringstream stream;
+        Serializer<>::writeStream(stream, val1, val);
+        Serializer<>::readStream(stream, nval1, nval);
+        REQUIRE(nval1 == val1);
+        REQUIRE(nval == val);
+        REQUIRE_THROWS_AS(Serializer<>::readData<decltype(val)>(data.data(), data.size() - 1),
+                          Serialization::DeserializationError);
+        REQUIRE(Serializer<>::isBytewise<BytePair>);
+        REQUIRE(!Serializer<order>::isBytewise<BytePair>);
+        REQUIRE(!Serializer<order>::isBytewise<std::array<uint8_t, 2>>);
+        std::vector<BytePair> pairs {{1, 2}, {3, 4}};
+        std::list<BytePair> pairList(pairs.begin(), pairs.end());
+        std::array<BytePair, 2> pairArray {pairs[0], pairs[1]};
+        size_t pairCount = 2;
+        auto pairData = Serializer<order>::serialize(pairCount);
+        pairData.insert(pairData.end(), {1, 2, 3, 4});
+        REQUIRE(Serializer<order>::serialize(pairs) == pairData);
+        REQUIRE(Serializer<order>::serialize(pairList) == pairData);
+        REQUIRE(Serializer<order>::serialize(pairArray) == std::vector<char>(pairData.begin() + sizeof(size_t), pairData.end()));
+        REQUIRE(Serializer<order>::deserialize<decltype(pairs)>(pairData) == pairs);
+        REQUIRE(Serializer<order>::deserialize<decltype(pairList)>(pairData) == pairList);
+        REQUIRE(Serializer<order>::deserialize<decltype(pairArray)>(Serializer<order>::serialize(pairArray)) == pairArray);
+    }
+#if defined(__cpp_lib_memory_resource)
+    SECTION("Memory resource")
+    {
+        typedef std::pmr::map<std::pmr::string, std::pmr::vector<std::pmr::string>> PmrMap;
+        auto size = GENERATE(take(1, random(1, 100)));
+        std::map<std::string, std::vector<std::string>> val;
+        std::set<std::string> val1;
+        for (int i = 0; i < size; ++i)
+        {
+            auto key = std::string(32, char('a' + i % 26)) + std::to_string(i);
+            val[key].assign(size_t(i % 4), key);
+            val1.insert(key);
+        }
+        auto data = Serializer<>::serialize(val, val1);
+        CountingResource upstream, fallback;
+        std::pmr::monotonic_buffer_resource arena(&upstream);
+        PmrMap nval(&arena);
+        std::pmr::set<std::pmr::string> nval1(&arena);
+        auto previous = std::pmr::set_default_resource(&fallback);
+        Serializer<>::readData(data.data(), data.size(), nval, nval1);
+        auto nval2 = Serializer<>::deserialize<PmrMap>(Serializer<>::serialize(val), &arena);
+        std::pmr::set_default_resource(previous);
+        REQUIRE(fallback.allocations == 0);
+        REQUIRE(upstream.allocations > 0);
+        REQUIRE(Serializer<>::serialize(nval, nval1) == data);
+        REQUIRE(Serializer<>::serialize(nval2) == Serializer<>::serialize(val));
+        REQUIRE(nval2.get_allocator().resource() == &arena);
+        REQUIRE(nval2.begin()->first.get_allocator().resource() == &arena);
+        REQUIRE(nval2.rbegin()->second.get_allocator().resource() == &arena);
+        REQUIRE(nval1.begin()->get_allocator().resource() == &arena);
+    }
+#endif
     SECTION("Change order")
     {
         constexpr ByteOrder order = Host == BigEndian ? LittleEndian : BigEndian;
@@ -401,14 +1462,14 @@ TEST_CASE("Serializer test")
             auto nval = Serializer<order>::deserialize<decltype(val)>(data);
             REQUIRE(val == nval);
         }
-        SECTION("Arithmetic array (Array due to reorder)")
+        SECTION("Arithmetic array")
         {
             int val[5] = {GENERATE(take(1, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))),
                           GENERATE(take(1, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))),
                           GENERATE(take(1, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))),
                           GENERATE(take(1, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))),
                           GENERATE(take(1, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max())))};
-            REQUIRE(Serializer<order>::priorityType<decltype(val)> == Serializer<order>::Array);
+            REQUIRE(Serializer<order>::priorityType<decltype(val)> == Serializer<order>::ArithmeticArray);
             auto data = Serializer<order>::serialize<int[5]>(val);
             REQUIRE(data.size() == Serializer<order>::byteSize(val));
             REQUIRE(data.size() == sizeof(val));
@@ -416,11 +1477,11 @@ TEST_CASE("Serializer test")
             Serializer<order>::deserialize<decltype(val)>(data, nval);
             REQUIRE(std::equal(std::begin(val), std::end(val), std::begin(nval), std::end(nval)));
         }
-        SECTION("Arithmetic contiguous (Iterable due to reorder)")
+        SECTION("Arithmetic contiguous")
         {
             auto size = GENERATE(take(1, random(1, 1024)));
             auto val = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
-            REQUIRE(Serializer<order>::priorityType<decltype(val)> == Serializer<order>::Iterable);
+            REQUIRE(Serializer<order>::priorityType<decltype(val)> == Serializer<order>::ArithmeticContiguous);
             auto data = Serializer<order>::serialize(val);
             REQUIRE(data.size() == Serializer<order>::byteSize(val));
             REQUIRE(data.size() == sizeof(val.size()) + val.size() * sizeof(val[0]));
@@ -473,6 +1534,51 @@ TEST_CASE("Serializer test")
             Serializer<order>::deserialize<decltype(val)>(data, nval);
             REQUIRE(std::equal(std::begin(val), std::end(val), std::begin(nval), std::end(nval)));
         }
+        SECTION("Floating point")
+        {
+            auto val0 = GENERATE(take(1, random(-1e6f, 1e6f)));
+            auto val1 = GENERATE(take(1, random(-1e300, 1e300)));
+            std::vector<double> val2 {val1, -val1, std::numeric_limits<double>::infinity(), 0.5};
+            auto data = Serializer<order>::serialize(val0, val1, val2);
+            REQUIRE(data.size() == sizeof(val0) + sizeof(val1) + sizeof(val2.size()) + val2.size() * sizeof(double));
+            uint32_t bits0;
+            memcpy(&bits0, &val0, sizeof(bits0));
+            REQUIRE(Serializer<order>::serialize(bits0) == std::vector<char>(data.begin(), data.begin() + sizeof(val0)));
+            decltype(val0) nval0;
+            decltype(val1) nval1;
+            decltype(val2) nval2;
+            Serializer<order>::deserialize(data, nval0, nval1, nval2);
+            REQUIRE(val0 == nval0);
+            REQUIRE(val1 == nval1);
+            REQUIRE(val2 == nval2);
+        }
+        SECTION("Bulk reorder")
+        {
+            auto size = GENERATE(take(1, random(1, 1024)));
+            auto valarr = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
+            std::vector<uint16_t> val0 {valarr.begin(), valarr.end()};
+            std::vector<uint32_t> val1 {valarr.begin(), valarr.end()};
+            std::vector<uint64_t> val2 {valarr.begin(), valarr.end()};
+            std::array<uint32_t, 3> val3 {uint32_t(valarr[0]), 2, 3};
+            auto data = Serializer<order>::serialize(val0, val1, val2, val3);
+            std::list<uint16_t> lval0 {val0.begin(), val0.end()};
+            std::list<uint32_t> lval1 {val1.begin(), val1.end()};
+            std::list<uint64_t> lval2 {val2.begin(), val2.end()};
+            std::tuple<uint32_t, uint32_t, uint32_t> lval3 {val3[0], val3[1], val3[2]};
+            REQUIRE(data == Serializer<order>::serialize(lval0, lval1, lval2, lval3));
+            decltype(val0) nval0;
+            decltype(val1) nval1;
+            decltype(val2) nval2;
+            decltype(val3) nval3;
+            Serializer<order>::deserialize(data, nval0, nval1, nval2, nval3);
+            REQUIRE(val0 == nval0);
+            REQUIRE(val1 == nval1);
+            REQUIRE(val2 == nval2);
+            REQUIRE(val3 == nval3);
+            Serialization::Buffer buffer;
+            Serializer<order>::appendData(buffer, val0, val1, val2, val3);
+            REQUIRE(std::equal(buffer.begin(), buffer.end(), data.begin(), data.end()));
+        }
         SECTION("Non serializable")
         {
             REQUIRE(Serializer<order>::priorityType<char*> == Serializer<order>::NonSerializable);
@@ -500,14 +1606,14 @@ TEST_CASE("Serializer test")
             auto nval = Serializer<Network, uint64_t>::deserialize<decltype(val)>(data);
             REQUIRE(val == nval);
         }
-        SECTION("Arithmetic array (Array due to reorder)")
+        SECTION("Arithmetic array")
         {
             int val[5] = {GENERATE_COPY(take(1, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))),
                           GENERATE_COPY(take(1, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))),
                           GENERATE_COPY(take(1, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))),
                           GENERATE_COPY(take(1, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))),
                           GENERATE_COPY(take(1, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max())))};
-            REQUIRE(Serializer<Network, uint64_t>::priorityType<decltype(val)> == Serializer<Network, uint64_t>::Array);
+            REQUIRE(Serializer<Network, uint64_t>::priorityType<decltype(val)> == Serializer<Network, uint64_t>::ArithmeticArray);
             auto data = Serializer<Network, uint64_t>::serialize<int[5]>(val);
             REQUIRE(data.size() == Serializer<Network, uint64_t>::byteSize(val));
             REQUIRE(data.size() == sizeof(val));
@@ -515,11 +1621,11 @@ TEST_CASE("Serializer test")
             Serializer<Network, uint64_t>::deserialize<decltype(val)>(data, nval);
             REQUIRE(std::equal(std::begin(val), std::end(val), std::begin(nval), std::end(nval)));
         }
-        SECTION("Arithmetic contiguous (Iterable due to reorder)")
+        SECTION("Arithmetic contiguous")
         {
             auto size = GENERATE(take(1, random(1, 1024)));
             std::vector<int> val = GENERATE_COPY(take(1, chunk(size, random(std::numeric_limits<int>::min(), std::numeric_limits<int>::max()))));
-            REQUIRE(Serializer<Network, uint64_t>::priorityType<decltype(val)> == Serializer<Network, uint64_t>::Iterable);
+            REQUIRE(Serializer<Network, uint64_t>::priorityType<decltype(val)> == Serializer<Network, uint64_t>::ArithmeticContiguous);
             auto data = Serializer<Network, uint64_t>::serialize(val);
             REQUIRE(data.size() == Serializer<Network, uint64_t>::byteSize(val));
             REQUIRE(data.size() == sizeof(val.size()) + val.size() * sizeof(val[0]));